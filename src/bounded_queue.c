@@ -0,0 +1,211 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "bounded_queue.h"
+
+static const char *policy_names[] = { "block", "drop-oldest", "drop-newest", "latest" };
+
+static uint8_t *slot_ptr(BoundedQueue *q, int slot)
+{
+    return q->items + (size_t)slot * q->item_size;
+}
+
+/* Overwrites a queued item with a newer one, except the kept bytes. */
+static void replace_item(BoundedQueue *q, int slot, const void *item)
+{
+    uint8_t *dst = slot_ptr(q, slot);
+    const uint8_t *src = item;
+    size_t tail = q->keep_offset + q->keep_size;
+
+    memcpy(dst, src, q->keep_offset);
+    memcpy(dst + tail, src + tail, q->item_size - tail);
+}
+
+/* Removes the head item; the caller holds the lock. */
+static void take_head(BoundedQueue *q, void *out)
+{
+    if (out)
+        memcpy(out, slot_ptr(q, q->head), q->item_size);
+
+    if (q->slot_of_key && q->keys[q->head] != QUEUE_KEY_NONE)
+        q->slot_of_key[q->keys[q->head]] = -1;
+
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+}
+
+/* PUBLIC API */
+
+int queue_init(BoundedQueue *q, const char *name, QueuePolicy policy,
+               int capacity, size_t item_size, uint32_t key_count)
+{
+    memset(q, 0, sizeof(*q));
+    q->name      = name;
+    q->policy    = policy;
+    q->item_size = item_size;
+    q->capacity  = capacity > 0 ? capacity : 1;
+
+    q->items = calloc((size_t)q->capacity, item_size);
+    if (!q->items)
+        return -1;
+
+    if (policy == QUEUE_KEEP_LATEST) {
+        q->key_count   = key_count;
+        q->keys        = calloc((size_t)q->capacity, sizeof(*q->keys));
+        q->slot_of_key = malloc(key_count * sizeof(*q->slot_of_key));
+        if (!q->keys || !q->slot_of_key)
+            return -1;
+        for (uint32_t k = 0; k < key_count; k++)
+            q->slot_of_key[k] = -1;
+    }
+
+    platform_mutex_init(&q->lock);
+    platform_cond_init(&q->not_empty);
+    platform_cond_init(&q->not_full);
+    return 0;
+}
+
+void queue_keep_on_replace(BoundedQueue *q, size_t offset, size_t size)
+{
+    if (offset > q->item_size || size > q->item_size - offset)
+        return;
+
+    platform_mutex_lock(&q->lock);
+    q->keep_offset = offset;
+    q->keep_size   = size;
+    platform_mutex_unlock(&q->lock);
+}
+
+int queue_push(BoundedQueue *q, const void *item, uint32_t key)
+{
+    int queued = 1;
+
+    /* Clamping would merge unrelated keys. */
+    if (q->slot_of_key && key != QUEUE_KEY_NONE && key >= q->key_count)
+        return -1;
+
+    platform_mutex_lock(&q->lock);
+
+    if (q->closed) {
+        platform_mutex_unlock(&q->lock);
+        return 0;
+    }
+
+    if (q->slot_of_key && key != QUEUE_KEY_NONE) {
+        int slot = q->slot_of_key[key];
+        if (slot >= 0) {
+            replace_item(q, slot, item);
+            q->stats.pushed++;
+            q->stats.replaced++;
+            platform_mutex_unlock(&q->lock);
+            return 1;
+        }
+    }
+
+    if (q->count == q->capacity) {
+        switch (q->policy) {
+        case QUEUE_BLOCK:
+            q->stats.blocked++;
+            while (q->count == q->capacity && !q->closed)
+                platform_cond_wait(&q->not_full, &q->lock);
+            if (q->closed)
+                queued = 0;
+            break;
+        case QUEUE_DROP_NEWEST:
+            q->stats.dropped_newest++;
+            queued = 0;
+            break;
+        case QUEUE_DROP_OLDEST:
+        case QUEUE_KEEP_LATEST:
+            take_head(q, NULL);
+            q->stats.dropped_oldest++;
+            break;
+        }
+    }
+
+    if (queued) {
+        int slot = (q->head + q->count) % q->capacity;
+        memcpy(slot_ptr(q, slot), item, q->item_size);
+        if (q->slot_of_key) {
+            q->keys[slot] = key;
+            if (key != QUEUE_KEY_NONE)
+                q->slot_of_key[key] = slot;
+        }
+        q->count++;
+        q->stats.pushed++;
+        if (q->count > q->stats.high_watermark)
+            q->stats.high_watermark = q->count;
+        platform_cond_broadcast(&q->not_empty);
+    }
+
+    platform_mutex_unlock(&q->lock);
+    return queued;
+}
+
+int queue_pop(BoundedQueue *q, void *out)
+{
+    platform_mutex_lock(&q->lock);
+
+    while (q->count == 0 && !q->closed)
+        platform_cond_wait(&q->not_empty, &q->lock);
+
+    int got = q->count > 0;
+    if (got) {
+        take_head(q, out);
+        q->stats.popped++;
+        if (q->policy == QUEUE_BLOCK)
+            platform_cond_broadcast(&q->not_full);
+    }
+
+    platform_mutex_unlock(&q->lock);
+    return got;
+}
+
+int queue_try_pop(BoundedQueue *q, void *out)
+{
+    platform_mutex_lock(&q->lock);
+
+    int got = q->count > 0;
+    if (got) {
+        take_head(q, out);
+        q->stats.popped++;
+        if (q->policy == QUEUE_BLOCK)
+            platform_cond_broadcast(&q->not_full);
+    }
+
+    platform_mutex_unlock(&q->lock);
+    return got;
+}
+
+void queue_close(BoundedQueue *q)
+{
+    platform_mutex_lock(&q->lock);
+    q->closed = 1;
+    platform_cond_broadcast(&q->not_empty);
+    platform_cond_broadcast(&q->not_full);
+    platform_mutex_unlock(&q->lock);
+}
+
+void queue_get_stats(BoundedQueue *q, QueueStats *out)
+{
+    platform_mutex_lock(&q->lock);
+    *out = q->stats;
+    out->depth = q->count;
+    platform_mutex_unlock(&q->lock);
+}
+
+int queue_parse_policy(const char *text, QueuePolicy *policy)
+{
+    for (int i = 0; i < (int)(sizeof(policy_names) / sizeof(policy_names[0])); i++) {
+        if (strcmp(text, policy_names[i]) == 0) {
+            *policy = (QueuePolicy)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *queue_policy_name(QueuePolicy policy)
+{
+    return policy_names[policy];
+}
@@ -0,0 +1,106 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+/* Fixed-capacity FIFO of fixed-size items between two pipeline stages.
+ *
+ * What happens when a producer finds the queue full is chosen per queue:
+ *
+ *   QUEUE_BLOCK        wait for space (backpressure to the producer)
+ *   QUEUE_DROP_OLDEST  discard the oldest queued item
+ *   QUEUE_DROP_NEWEST  discard the item being pushed
+ *   QUEUE_KEEP_LATEST  an item whose key is already queued replaces it
+ *                      in place, keeping its position and any bytes set
+ *                      with queue_keep_on_replace(); a full queue of
+ *                      distinct keys then drops the oldest
+ *
+ * Every discarded item is counted by reason. All storage is allocated
+ * by queue_init().
+ */
+
+/* Key for items that must never be replaced (QUEUE_KEEP_LATEST). */
+#define QUEUE_KEY_NONE 0xFFFFFFFFu
+
+typedef enum
+{
+    QUEUE_BLOCK,
+    QUEUE_DROP_OLDEST,
+    QUEUE_DROP_NEWEST,
+    QUEUE_KEEP_LATEST
+} QueuePolicy;
+
+typedef struct
+{
+    uint64_t pushed;
+    uint64_t popped;
+    uint64_t dropped_oldest;
+    uint64_t dropped_newest;
+    uint64_t replaced;        /* Superseded by a newer item with the same key */
+    uint64_t blocked;         /* Pushes that had to wait */
+    int      depth;
+    int      high_watermark;
+} QueueStats;
+
+typedef struct
+{
+    const char      *name;
+    QueuePolicy      policy;
+    size_t           item_size;
+    int              capacity;
+    int              head;
+    int              count;
+    int              closed;
+    uint8_t         *items;
+    uint32_t        *keys;         /* Key of each slot (QUEUE_KEEP_LATEST) */
+    int32_t         *slot_of_key;  /* Queued slot per key, -1 if none */
+    uint32_t         key_count;
+    size_t           keep_offset;  /* Bytes a replacing item leaves as they were */
+    size_t           keep_size;
+    QueueStats       stats;
+    platform_mutex_t lock;
+    platform_cond_t  not_empty;
+    platform_cond_t  not_full;
+} BoundedQueue;
+
+/* Allocate a queue of capacity items. key_count bounds the keys passed
+ * to queue_push() for QUEUE_KEEP_LATEST (ignored otherwise).
+ * Returns 0 on success, -1 if out of memory.
+ */
+int queue_init(BoundedQueue *q, const char *name, QueuePolicy policy,
+               int capacity, size_t item_size, uint32_t key_count);
+
+/* Keep size bytes at offset of a queued item when a newer one replaces
+ * it (QUEUE_KEEP_LATEST), e.g. the time it was first queued.
+ */
+void queue_keep_on_replace(BoundedQueue *q, size_t offset, size_t size);
+
+/* Add an item according to the queue policy. Returns 1 if it was queued,
+ * 0 if it was dropped (QUEUE_DROP_NEWEST, or the queue is closed),
+ * -1 if key is neither QUEUE_KEY_NONE nor below key_count
+ * (QUEUE_KEEP_LATEST); the item is not queued then.
+ */
+int queue_push(BoundedQueue *q, const void *item, uint32_t key);
+
+/* Remove the oldest item into out, waiting while the queue is empty.
+ * Returns 0 once the queue is closed and drained.
+ */
+int queue_pop(BoundedQueue *q, void *out);
+
+/* Like queue_pop() but returns 0 immediately when empty. */
+int queue_try_pop(BoundedQueue *q, void *out);
+
+/* Wake all waiters; pushes are refused from now on. */
+void queue_close(BoundedQueue *q);
+
+void queue_get_stats(BoundedQueue *q, QueueStats *out);
+
+/* "block", "drop-oldest", "drop-newest" or "latest". Returns 0 on success. */
+int queue_parse_policy(const char *text, QueuePolicy *policy);
+
+const char *queue_policy_name(QueuePolicy policy);
+
+#endif /* BOUNDED_QUEUE_H */
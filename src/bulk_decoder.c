@@ -0,0 +1,728 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bulk_decoder.h"
+#include "parser.h"
+#include "can_message.h"
+#include "platform.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define BULK_MAX_THREADS   64
+#define BULK_MIN_CHUNK     (256 * 1024)  /* Smaller inputs are not worth splitting */
+#define BULK_ROW_MAX       192           /* Upper bound of one formatted CSV row */
+#define BULK_OUT_BUFFER    (1 << 20)
+#define BULK_BLOCK_ROWS    2048          /* Rows a worker hands to the merge at a time */
+#define BULK_RING_BLOCKS   4             /* Blocks in flight per worker */
+
+/* One output row: where it sits in its block's text and its time. */
+typedef struct
+{
+    uint64_t timestamp_us;
+    uint32_t offset;
+    uint32_t length;
+} OutputRecord;
+
+/* Rows of a chunk, in timestamp order, ready to be merged. */
+typedef struct
+{
+    OutputRecord records[BULK_BLOCK_ROWS];
+    size_t       count;
+    size_t       text_len;
+    char         text[BULK_BLOCK_ROWS * BULK_ROW_MAX];
+} OutputBlock;
+
+/* Work and results of one thread.
+ *
+ * The worker fills the blocks of its ring in turn and publishes each one
+ * full; the merge writes them out and releases them. Memory is bounded by
+ * the ring, whatever the size of the trace.
+ */
+typedef struct
+{
+    const char   *begin;
+    const char   *end;
+    const char   *next_line;
+
+    OutputBlock  *ring;             /* BULK_RING_BLOCKS blocks */
+    uint64_t      published;        /* Blocks handed to the merge */
+    uint64_t      released;         /* Blocks the merge is done with */
+    int           done;             /* Every block is published */
+    int           threaded;         /* Decoded by its own thread, else by the merge */
+    int           stop;             /* The merge gave up: publish nothing more */
+    platform_mutex_t lock;
+    platform_cond_t  changed;
+    uint64_t      newest_us;        /* Latest timestamp published so far */
+
+    /* Merge side */
+    OutputBlock  *current;
+    size_t        head;
+
+    /* Last wall-clock string of can_log.txt lines and its conversion */
+    char          last_datetime[20];
+    uint64_t      last_datetime_us;
+
+    uint64_t      frames;
+    uint64_t      rows;
+    uint64_t      unknown_ids;
+    uint64_t      dlc_errors;
+    uint64_t      crc_errors;
+    uint64_t      skipped_lines;
+    uint64_t      late_rows;        /* Older than an already published row */
+} DecodeChunk;
+
+/* FILE MAPPING */
+
+typedef struct
+{
+    const char *data;
+    size_t      size;
+#ifdef _WIN32
+    HANDLE      file;
+    HANDLE      mapping;
+#endif
+} MappedFile;
+
+static int map_file(const char *path, MappedFile *m)
+{
+    memset(m, 0, sizeof(*m));
+
+#ifdef _WIN32
+    m->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                          OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m->file == INVALID_HANDLE_VALUE)
+        return -1;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m->file, &size)) {
+        CloseHandle(m->file);
+        return -1;
+    }
+    m->size = (size_t)size.QuadPart;
+    if (m->size == 0) {
+        /* Nothing to map */
+        CloseHandle(m->file);
+        m->file = NULL;
+        return 0;
+    }
+
+    m->mapping = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m->mapping) {
+        CloseHandle(m->file);
+        return -1;
+    }
+    m->data = MapViewOfFile(m->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m->data) {
+        CloseHandle(m->mapping);
+        CloseHandle(m->file);
+        return -1;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    m->size = (size_t)st.st_size;
+
+    if (m->size > 0) {
+        void *p = mmap(NULL, m->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(p, m->size, MADV_SEQUENTIAL);
+        m->data = p;
+    }
+    close(fd);
+#endif
+    return 0;
+}
+
+static void unmap_file(MappedFile *m)
+{
+#ifdef _WIN32
+    if (m->data)
+        UnmapViewOfFile(m->data);
+    if (m->mapping)
+        CloseHandle(m->mapping);
+    if (m->file && m->file != INVALID_HANDLE_VALUE)
+        CloseHandle(m->file);
+#else
+    if (m->data)
+        munmap((void *)m->data, m->size);
+#endif
+    m->data = NULL;
+}
+
+/* LINE PARSING */
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static const char *skip_spaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    return p;
+}
+
+/* candump -l format: "(sec.usec) iface ID#DATA".
+ * Returns 1 for a frame, 0 if the line is not candump, -1 for frames
+ * this decoder does not handle (extended ID, remote, CAN FD).
+ */
+static int parse_candump_line(const char *p, const char *end, CAN_Message *msg)
+{
+    if (p >= end || *p != '(')
+        return 0;
+    p++;
+
+    uint64_t sec = 0, usec = 0;
+    int digits = 0;
+
+    while (p < end && is_digit(*p))
+        sec = sec * 10 + (uint64_t)(*p++ - '0');
+    if (p >= end || *p != '.')
+        return 0;
+    p++;
+    while (p < end && is_digit(*p)) {
+        if (digits < 6) {
+            usec = usec * 10 + (uint64_t)(*p - '0');
+            digits++;
+        }
+        p++;
+    }
+    while (digits++ < 6)
+        usec *= 10;
+    if (p >= end || *p != ')')
+        return 0;
+
+    /* Interface name */
+    p = skip_spaces(p + 1, end);
+    while (p < end && *p != ' ' && *p != '\t')
+        p++;
+    p = skip_spaces(p, end);
+
+    uint32_t id = 0;
+    int id_digits = 0;
+    int h;
+    while (p < end && (h = hex_digit(*p)) >= 0) {
+        id = (id << 4) | (uint32_t)h;
+        id_digits++;
+        p++;
+    }
+    if (p >= end || *p != '#' || id_digits == 0)
+        return 0;
+    p++;
+
+    if (id_digits > 3 || id > 0x7FF)
+        return -1;
+    if (p < end && (*p == '#' || *p == 'R' || *p == 'r'))
+        return -1;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->id = (uint16_t)id;
+    msg->timestamp_us = sec * 1000000u + usec;
+
+    while (p + 1 < end && msg->dlc < 8) {
+        int hi = hex_digit(p[0]);
+        int lo = hex_digit(p[1]);
+        if (hi < 0 || lo < 0)
+            break;
+        msg->data[msg->dlc++] = (uint8_t)((hi << 4) | lo);
+        p += 2;
+    }
+    return 1;
+}
+
+/* can_log.txt format written by logger.c:
+ * "YYYY-MM-DD HH:MM:SS | 0xID | DLC | B0 B1 ... | ..."
+ * Returns 1 for a frame, 0 otherwise.
+ */
+static int parse_log_line(DecodeChunk *c, const char *p, const char *end, CAN_Message *msg)
+{
+    static const char pattern[] = "dddd-dd-dd dd:dd:dd";
+
+    if (end - p < 19)
+        return 0;
+    for (int i = 0; i < 19; i++) {
+        if (pattern[i] == 'd' ? !is_digit(p[i]) : p[i] != pattern[i])
+            return 0;
+    }
+
+    if (memcmp(c->last_datetime, p, 19) != 0) {
+        struct tm t;
+        memset(&t, 0, sizeof(t));
+        t.tm_year  = atoi(p) - 1900;
+        t.tm_mon   = atoi(p + 5) - 1;
+        t.tm_mday  = atoi(p + 8);
+        t.tm_hour  = atoi(p + 11);
+        t.tm_min   = atoi(p + 14);
+        t.tm_sec   = atoi(p + 17);
+        t.tm_isdst = -1;
+
+        time_t when = mktime(&t);
+        if (when == (time_t)-1)
+            return 0;
+
+        memcpy(c->last_datetime, p, 19);
+        c->last_datetime_us = (uint64_t)when * 1000000u;
+    }
+    p += 19;
+
+    p = skip_spaces(p, end);
+    if (end - p < 3 || p[0] != '|')
+        return 0;
+    p = skip_spaces(p + 1, end);
+    if (end - p < 3 || p[0] != '0' || (p[1] != 'x' && p[1] != 'X'))
+        return 0;
+    p += 2;
+
+    uint32_t id = 0;
+    int h;
+    while (p < end && (h = hex_digit(*p)) >= 0) {
+        id = (id << 4) | (uint32_t)h;
+        p++;
+    }
+    if (id > 0x7FF)
+        return 0;
+
+    p = skip_spaces(p, end);
+    if (p >= end || *p != '|')
+        return 0;
+    p = skip_spaces(p + 1, end);
+
+    int dlc = 0;
+    while (p < end && is_digit(*p))
+        dlc = dlc * 10 + (*p++ - '0');
+    if (dlc > 8)
+        return 0;
+
+    p = skip_spaces(p, end);
+    if (p >= end || *p != '|')
+        return 0;
+    p++;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->id = (uint16_t)id;
+    msg->timestamp_us = c->last_datetime_us;
+
+    for (int i = 0; i < dlc; i++) {
+        p = skip_spaces(p, end);
+        if (end - p < 2 || hex_digit(p[0]) < 0 || hex_digit(p[1]) < 0)
+            return 0;
+        msg->data[i] = (uint8_t)((hex_digit(p[0]) << 4) | hex_digit(p[1]));
+        p += 2;
+    }
+    msg->dlc = (uint8_t)dlc;
+    return 1;
+}
+
+/* WORKER */
+
+/* Writes v in decimal, zero-padded to at least min_digits. */
+static char *put_uint(char *p, uint64_t v, int min_digits)
+{
+    char tmp[20];
+    int n = 0;
+
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n < min_digits)
+        tmp[n++] = '0';
+    while (n)
+        *p++ = tmp[--n];
+    return p;
+}
+
+static char *put_str(char *p, const char *s)
+{
+    size_t n = strlen(s);
+    memcpy(p, s, n);
+    return p + n;
+}
+
+/* Same digits as printf("%.2f"), without the printf cost.
+ * float * 100 is exact in double, so ties round to even like printf.
+ * Like printf, negative values that round to zero keep their sign ("-0.00").
+ * Returns NULL for values it does not handle (NaN, inf, huge).
+ */
+static char *put_fixed2(char *p, float value)
+{
+    double scaled = (double)value * 100.0;
+    int negative = signbit(scaled) != 0;
+
+    if (negative)
+        scaled = -scaled;
+    if (!(scaled < 1e17))
+        return NULL;
+
+    uint64_t q = (uint64_t)scaled;
+    double frac = scaled - (double)q;
+    if (frac > 0.5 || (frac == 0.5 && (q & 1)))
+        q++;
+
+    if (negative)
+        *p++ = '-';
+    p = put_uint(p, q / 100, 1);
+    *p++ = '.';
+    return put_uint(p, q % 100, 2);
+}
+
+static void append_row(OutputBlock *b, const CAN_Message *msg, const DecodedSignal *d)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char *row = b->text + b->text_len;
+    char *p = row;
+
+    /* timestamp,can_id,signal,value,unit,status */
+    p = put_uint(p, msg->timestamp_us / 1000000u, 1);
+    *p++ = '.';
+    p = put_uint(p, msg->timestamp_us % 1000000u, 6);
+    p = put_str(p, ",0x");
+    *p++ = hex[(msg->id >> 8) & 0xF];
+    *p++ = hex[(msg->id >> 4) & 0xF];
+    *p++ = hex[msg->id & 0xF];
+    *p++ = ',';
+    p = put_str(p, d->name);
+    *p++ = ',';
+
+    char *v = put_fixed2(p, d->value);
+    p = v ? v : p + snprintf(p, 48, "%.2f", d->value);
+
+    *p++ = ',';
+    p = put_str(p, d->unit);
+    p = put_str(p, d->out_of_range ? ",WARNING\n" : ",OK\n");
+
+    OutputRecord *r = &b->records[b->count++];
+    r->timestamp_us = msg->timestamp_us;
+    r->offset = (uint32_t)b->text_len;
+    r->length = (uint32_t)(p - row);
+
+    b->text_len += r->length;
+}
+
+static int compare_records(const void *a, const void *b)
+{
+    const OutputRecord *ra = a, *rb = b;
+
+    if (ra->timestamp_us != rb->timestamp_us)
+        return ra->timestamp_us < rb->timestamp_us ? -1 : 1;
+    /* Offsets follow input order, which keeps equal timestamps stable. */
+    return ra->offset < rb->offset ? -1 : (ra->offset > rb->offset);
+}
+
+/* Decodes lines into the next free block of the ring until it is full
+ * or the chunk ends, then publishes it. Rows are sorted within the block;
+ * a row older than one already published is counted late and stays out
+ * of order.
+ */
+static void fill_block(DecodeChunk *c)
+{
+    DecodedSignal decoded[DECODE_MAX_SIGNALS];
+    const char *p = c->next_line;
+    int sorted = 1;
+
+    platform_mutex_lock(&c->lock);
+    while (c->published - c->released >= BULK_RING_BLOCKS && !c->stop)
+        platform_cond_wait(&c->changed, &c->lock);
+    if (c->stop) {
+        c->done = 1;
+        platform_mutex_unlock(&c->lock);
+        return;
+    }
+    platform_mutex_unlock(&c->lock);
+
+    OutputBlock *b = &c->ring[c->published % BULK_RING_BLOCKS];
+    b->count    = 0;
+    b->text_len = 0;
+
+    while (p < c->end && b->count + DECODE_MAX_SIGNALS <= BULK_BLOCK_ROWS) {
+        const char *nl = memchr(p, '\n', (size_t)(c->end - p));
+        const char *line_end = nl ? nl : c->end;
+        const char *next = nl ? nl + 1 : c->end;
+
+        if (line_end > p && line_end[-1] == '\r')
+            line_end--;
+
+        CAN_Message msg;
+        int r = parse_candump_line(p, line_end, &msg);
+        if (r == 0)
+            r = parse_log_line(c, p, line_end, &msg);
+        p = next;
+
+        if (r <= 0) {
+            c->skipped_lines++;
+            continue;
+        }
+
+        c->frames++;
+        int n = decode_can_message(&msg, decoded, DECODE_MAX_SIGNALS);
+        if (n == DECODE_UNKNOWN_ID) {
+            c->unknown_ids++;
+            continue;
+        }
+        if (n == DECODE_DLC_MISMATCH) {
+            c->dlc_errors++;
+            continue;
+        }
+        if (n == DECODE_E2E_CRC) {
+            c->crc_errors++;
+            continue;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (b->count > 0 && b->records[b->count - 1].timestamp_us > msg.timestamp_us)
+                sorted = 0;
+            append_row(b, &msg, &decoded[i]);
+        }
+        c->rows += (uint64_t)n;
+    }
+    c->next_line = p;
+
+    if (!sorted)
+        qsort(b->records, b->count, sizeof(OutputRecord), compare_records);
+
+    for (size_t i = 0; i < b->count && b->records[i].timestamp_us < c->newest_us; i++)
+        c->late_rows++;
+    if (b->count > 0 && b->records[b->count - 1].timestamp_us > c->newest_us)
+        c->newest_us = b->records[b->count - 1].timestamp_us;
+
+    platform_mutex_lock(&c->lock);
+    if (b->count > 0)
+        c->published++;
+    if (p >= c->end)
+        c->done = 1;
+    platform_cond_broadcast(&c->changed);
+    platform_mutex_unlock(&c->lock);
+}
+
+static void *decode_chunk(void *arg)
+{
+    DecodeChunk *c = arg;
+
+    while (!c->done)
+        fill_block(c);
+    return NULL;
+}
+
+/* MERGE */
+
+/* Releases the block the merge has written out and moves to the next
+ * one of the chunk. Returns 0, or -1 once the chunk has no more rows.
+ */
+static int next_block(DecodeChunk *c)
+{
+    platform_mutex_lock(&c->lock);
+    if (c->current) {
+        c->current = NULL;
+        c->released++;
+        platform_cond_broadcast(&c->changed);
+    }
+
+    while (c->published == c->released && !c->done) {
+        if (c->threaded) {
+            platform_cond_wait(&c->changed, &c->lock);
+            continue;
+        }
+        /* No thread for this chunk: decode its next block here. */
+        platform_mutex_unlock(&c->lock);
+        fill_block(c);
+        platform_mutex_lock(&c->lock);
+    }
+
+    if (c->published > c->released) {
+        c->current = &c->ring[c->released % BULK_RING_BLOCKS];
+        c->head    = 0;
+    }
+    platform_mutex_unlock(&c->lock);
+
+    return c->current ? 0 : -1;
+}
+
+/* K-way merge of the chunk streams, block by block as the workers
+ * publish them; ties go to the earlier chunk.
+ */
+static int merge_chunks(DecodeChunk *chunks, int n, FILE *out)
+{
+    int live[BULK_MAX_THREADS];
+    int count = 0;
+
+    if (fputs("timestamp,can_id,signal,value,unit,status\n", out) < 0)
+        return -1;
+
+    for (int i = 0; i < n; i++) {
+        if (next_block(&chunks[i]) == 0)
+            live[count++] = i;
+    }
+
+    while (count > 0) {
+        int best = 0;
+        for (int k = 1; k < count; k++) {
+            const DecodeChunk *a = &chunks[live[k]];
+            const DecodeChunk *b = &chunks[live[best]];
+            if (a->current->records[a->head].timestamp_us <
+                b->current->records[b->head].timestamp_us)
+                best = k;
+        }
+
+        DecodeChunk *c = &chunks[live[best]];
+        const OutputRecord *r = &c->current->records[c->head++];
+        if (fwrite(c->current->text + r->offset, 1, r->length, out) != r->length)
+            return -1;
+
+        if (c->head == c->current->count && next_block(c) < 0) {
+            /* Keep the remaining chunks in order, so ties still go to the earlier one. */
+            memmove(&live[best], &live[best + 1], sizeof(live[0]) * (size_t)(count - best - 1));
+            count--;
+        }
+    }
+    return 0;
+}
+
+/* PUBLIC API */
+
+int bulk_decode(const BulkDecodeOptions *opts)
+{
+    MappedFile in;
+    if (map_file(opts->input_path, &in) < 0) {
+        fprintf(stderr, "ERROR: Cannot open trace %s\n", opts->input_path);
+        return -1;
+    }
+
+    int threads = opts->threads > 0 ? opts->threads : platform_cpu_count();
+    if (threads > BULK_MAX_THREADS)
+        threads = BULK_MAX_THREADS;
+    if ((size_t)threads > in.size / BULK_MIN_CHUNK + 1)
+        threads = (int)(in.size / BULK_MIN_CHUNK + 1);
+
+    DecodeChunk *chunks = calloc((size_t)threads, sizeof(DecodeChunk));
+    OutputBlock *blocks = malloc((size_t)threads * BULK_RING_BLOCKS * sizeof(OutputBlock));
+    platform_thread_t tids[BULK_MAX_THREADS];
+    if (!chunks || !blocks) {
+        fprintf(stderr, "ERROR: Out of memory\n");
+        free(chunks);
+        free(blocks);
+        unmap_file(&in);
+        return -1;
+    }
+
+    FILE *out = stdout;
+    if (opts->output_path) {
+        out = fopen(opts->output_path, "wb");
+        if (!out) {
+            fprintf(stderr, "ERROR: Cannot create %s\n", opts->output_path);
+            free(chunks);
+            free(blocks);
+            unmap_file(&in);
+            return -1;
+        }
+    }
+    setvbuf(out, NULL, _IOFBF, BULK_OUT_BUFFER);
+
+    uint64_t start_us = platform_time_us();
+
+    /* Split at line boundaries. */
+    const char *data_end = in.data + in.size;
+    const char *p = in.data;
+    for (int i = 0; i < threads; i++) {
+        const char *end = (i == threads - 1) ? data_end : in.data + in.size * (size_t)(i + 1) / (size_t)threads;
+        if (end < p)
+            end = p;
+        if (end < data_end) {
+            const char *nl = memchr(end, '\n', (size_t)(data_end - end));
+            end = nl ? nl + 1 : data_end;
+        }
+        chunks[i].begin     = p;
+        chunks[i].end       = end;
+        chunks[i].next_line = p;
+        chunks[i].ring      = &blocks[(size_t)i * BULK_RING_BLOCKS];
+        platform_mutex_init(&chunks[i].lock);
+        platform_cond_init(&chunks[i].changed);
+        p = end;
+    }
+
+    /* Chunks without a thread are decoded by the merge as it needs them. */
+    int started = 0;
+    for (; started < threads; started++) {
+        chunks[started].threaded = 1;
+        if (platform_thread_start(&tids[started], decode_chunk, &chunks[started]) < 0) {
+            chunks[started].threaded = 0;
+            break;
+        }
+    }
+
+    /* Decoding and writing overlap: the merge writes blocks as they come. */
+    int rc = 0;
+    if (merge_chunks(chunks, threads, out) < 0 || fflush(out) != 0) {
+        fprintf(stderr, "ERROR: Write failed\n");
+        rc = -1;
+    }
+    if (out != stdout)
+        fclose(out);
+
+    for (int i = 0; i < threads; i++) {
+        platform_mutex_lock(&chunks[i].lock);
+        chunks[i].stop = 1;
+        platform_cond_broadcast(&chunks[i].changed);
+        platform_mutex_unlock(&chunks[i].lock);
+    }
+    for (int i = 0; i < started; i++)
+        platform_thread_join(tids[i]);
+
+    uint64_t end_us = platform_time_us();
+
+    uint64_t frames = 0, rows = 0, unknown = 0, dlc = 0, crc = 0, skipped = 0, late = 0;
+    for (int i = 0; i < threads; i++) {
+        frames  += chunks[i].frames;
+        rows    += chunks[i].rows;
+        unknown += chunks[i].unknown_ids;
+        dlc     += chunks[i].dlc_errors;
+        crc     += chunks[i].crc_errors;
+        skipped += chunks[i].skipped_lines;
+        late    += chunks[i].late_rows;
+    }
+    free(blocks);
+    free(chunks);
+
+    double secs = (end_us - start_us) / 1e6;
+    fprintf(stderr,
+            "Decoded %llu frames into %llu rows with %d thread(s) in %.3f s (%.1f MB/s)\n"
+            "Unknown IDs: %llu | DLC errors: %llu | E2E CRC errors: %llu | Skipped lines: %llu\n",
+            (unsigned long long)frames, (unsigned long long)rows, threads, secs,
+            secs > 0 ? in.size / secs / 1e6 : 0.0,
+            (unsigned long long)unknown, (unsigned long long)dlc,
+            (unsigned long long)crc, (unsigned long long)skipped);
+    if (late)
+        fprintf(stderr, "WARNING: %llu row(s) arrived too late to be put in timestamp order\n",
+                (unsigned long long)late);
+
+    unmap_file(&in);
+    return rc;
+}
@@ -0,0 +1,31 @@
+#ifndef BULK_DECODER_H
+#define BULK_DECODER_H
+
+/* Headless decoding of recorded traces.
+ *
+ * Accepted input lines (mixed freely, anything else is skipped):
+ *   candump log:  (1436509052.249713) can0 101#1388
+ *   can_log.txt:  2026-01-01 12:00:00 | 0x101 | 2 | 13 88 | ...
+ *
+ * Output is CSV, one row per decoded signal, in timestamp order:
+ *   timestamp,can_id,signal,value,unit,status
+ *
+ * Output is streamed in blocks of rows, so memory does not grow with the
+ * trace. Frames out of order in the input are reordered within a block;
+ * a row older than one already written is counted late and written as
+ * it comes.
+ */
+
+typedef struct
+{
+    const char *input_path;
+    const char *output_path;  /* NULL writes to stdout */
+    int         threads;      /* 0 uses one thread per CPU */
+} BulkDecodeOptions;
+
+/* Decode a trace file with the live decoder on all cores.
+ * Prints a summary to stderr. Returns 0 on success, -1 on error.
+ */
+int bulk_decode(const BulkDecodeOptions *opts);
+
+#endif /* BULK_DECODER_H */
@@ -0,0 +1,337 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bus_analyzer.h"
+#include "platform.h"
+
+#define ID_EMPTY        0xFFFFFFFFu     /* Never a valid id, CAN_EFF_FLAG or not */
+#define CRC15_POLY      0x4599
+#define FRAME_TAIL_BITS 13              /* CRC delimiter, ACK slot + delimiter, EOF, IFS */
+#define JITTER_GAIN     16
+#define ID_SLOTS        (2 * BUS_MAX_IDS)   /* Power of two, at most half full */
+
+typedef struct
+{
+    uint32_t id;
+    uint64_t frames;
+    uint64_t bits;
+    uint64_t first_us;
+    uint64_t last_us;
+    uint64_t last_period_us;
+    uint64_t max_gap_us;
+    double   jitter_us;
+    uint32_t window_frames;             /* Frames in the current window */
+    uint32_t rate;                      /* Frames in the last complete window */
+} IdTiming;
+
+typedef struct
+{
+    IdTiming ids[ID_SLOTS];
+    int      id_count;
+    uint64_t frames;
+    uint64_t bits;
+    uint64_t untracked;                 /* Frames of IDs beyond BUS_MAX_IDS */
+    uint64_t first_us;
+    uint64_t latest_us;                 /* Newest frame timestamp */
+    uint64_t window;                    /* Current window number */
+    uint64_t window_bits;
+    uint32_t window_frames;
+    uint64_t last_window_bits;
+    uint32_t last_window_frames;
+    uint64_t peak_window_bits;
+} BusState;
+
+static BusState         bus;
+static BusState         snapshot;       /* Copy formatted by the web thread */
+static uint32_t         bus_bitrate = BUS_DEFAULT_BITRATE;
+static platform_mutex_t bus_lock;
+
+/* FRAME LENGTH */
+
+/* Appends the count low bits of value, most significant first. */
+static int put_bits(uint8_t *bits, int n, uint32_t value, int count)
+{
+    for (int i = count - 1; i >= 0; i--)
+        bits[n++] = (value >> i) & 1;
+    return n;
+}
+
+int bus_frame_bits(const CAN_Message *msg)
+{
+    uint8_t bits[128];
+    int dlc = msg->dlc < 8 ? msg->dlc : 8;
+    int n = 0;
+
+    /* Arbitration and control field, from SOF */
+    bits[n++] = 0;
+    if (msg->id & CAN_EFF_FLAG) {
+        uint32_t id = msg->id & CAN_EFF_MASK;
+        n = put_bits(bits, n, id >> 18, 11);
+        n = put_bits(bits, n, 3, 2);            /* SRR, IDE recessive */
+        n = put_bits(bits, n, id & 0x3FFFF, 18);
+        n = put_bits(bits, n, 0, 3);            /* RTR, r1, r0 */
+    }
+    else {
+        n = put_bits(bits, n, msg->id & CAN_SFF_MASK, 11);
+        n = put_bits(bits, n, 0, 3);            /* RTR, IDE, r0 */
+    }
+    n = put_bits(bits, n, (uint32_t)dlc, 4);
+
+    for (int i = 0; i < dlc; i++)
+        n = put_bits(bits, n, msg->data[i], 8);
+
+    uint16_t crc = 0;
+    for (int i = 0; i < n; i++) {
+        int next = bits[i] ^ ((crc >> 14) & 1);
+        crc = (uint16_t)((crc << 1) & 0x7FFF);
+        if (next)
+            crc ^= CRC15_POLY;
+    }
+    n = put_bits(bits, n, crc, 15);
+
+    /* A stuff bit follows five equal bits and starts the next run. */
+    int stuff = 0, run = 1;
+    uint8_t level = bits[0];
+    for (int i = 1; i < n; i++) {
+        if (bits[i] == level)
+            run++;
+        else {
+            level = bits[i];
+            run = 1;
+        }
+        if (run == 5) {
+            stuff++;
+            level = !level;
+            run = 1;
+        }
+    }
+
+    return n + stuff + FRAME_TAIL_BITS;
+}
+
+/* PER-ID TABLE */
+
+static IdTiming *id_slot(uint32_t id)
+{
+    uint32_t mask = ID_SLOTS - 1;
+    uint32_t slot = (id * 2654435761u) >> 23 & mask;
+
+    for (uint32_t probe = 0; probe < ID_SLOTS; probe++, slot = (slot + 1) & mask) {
+        IdTiming *t = &bus.ids[slot];
+        if (t->id == id)
+            return t;
+        if (t->id == ID_EMPTY) {
+            if (bus.id_count >= BUS_MAX_IDS)
+                return NULL;
+            memset(t, 0, sizeof(*t));
+            t->id = id;
+            bus.id_count++;
+            return t;
+        }
+    }
+    return NULL;
+}
+
+/* Closes the current window: rates and load of the last full second. */
+static void close_window(uint64_t window)
+{
+    /* Gaps of more than one window leave nothing in the last one. */
+    int contiguous = window == bus.window + 1;
+
+    bus.last_window_bits   = contiguous ? bus.window_bits : 0;
+    bus.last_window_frames = contiguous ? bus.window_frames : 0;
+    if (bus.window_bits > bus.peak_window_bits)
+        bus.peak_window_bits = bus.window_bits;
+
+    for (int i = 0; i < ID_SLOTS; i++) {
+        IdTiming *t = &bus.ids[i];
+        if (t->id == ID_EMPTY)
+            continue;
+        t->rate = contiguous ? t->window_frames : 0;
+        t->window_frames = 0;
+    }
+
+    bus.window = window;
+    bus.window_bits = 0;
+    bus.window_frames = 0;
+}
+
+/* PUBLIC API */
+
+void bus_analyzer_init(uint32_t bitrate)
+{
+    platform_mutex_init(&bus_lock);
+    memset(&bus, 0, sizeof(bus));
+    for (int i = 0; i < ID_SLOTS; i++)
+        bus.ids[i].id = ID_EMPTY;
+
+    if (bitrate)
+        bus_bitrate = bitrate;
+}
+
+void bus_analyzer_frame(const CAN_Message *msg)
+{
+    int bits = bus_frame_bits(msg);
+    uint64_t ts = msg->timestamp_us;
+
+    platform_mutex_lock(&bus_lock);
+
+    if (bus.frames == 0) {
+        bus.first_us = ts;
+        bus.window   = ts / BUS_WINDOW_US;
+    }
+
+    /* Reordered frames never move the clock backwards. */
+    if (ts > bus.latest_us)
+        bus.latest_us = ts;
+    if (bus.latest_us / BUS_WINDOW_US != bus.window)
+        close_window(bus.latest_us / BUS_WINDOW_US);
+
+    bus.frames++;
+    bus.bits += (uint64_t)bits;
+    bus.window_bits += (uint64_t)bits;
+    bus.window_frames++;
+
+    IdTiming *t = id_slot(msg->id);
+    if (!t) {
+        bus.untracked++;
+    }
+    else {
+        if (t->frames == 0) {
+            t->first_us = ts;
+        }
+        else if (ts > t->last_us) {
+            uint64_t period = ts - t->last_us;
+
+            if (period > t->max_gap_us)
+                t->max_gap_us = period;
+
+            if (t->frames > 1) {
+                double d = (double)period - (double)t->last_period_us;
+                t->jitter_us += ((d < 0 ? -d : d) - t->jitter_us) / JITTER_GAIN;
+            }
+            t->last_period_us = period;
+        }
+
+        if (ts > t->last_us || t->frames == 0)
+            t->last_us = ts;
+        t->frames++;
+        t->bits += (uint64_t)bits;
+        t->window_frames++;
+    }
+
+    platform_mutex_unlock(&bus_lock);
+}
+
+/* REPORTING */
+
+static const BusState *take_snapshot(void)
+{
+    platform_mutex_lock(&bus_lock);
+    snapshot = bus;
+    platform_mutex_unlock(&bus_lock);
+    return &snapshot;
+}
+
+static double load_percent(uint64_t bits_per_window)
+{
+    return 100.0 * (double)bits_per_window * 1e6 / BUS_WINDOW_US / bus_bitrate;
+}
+
+static double average_load_percent(const BusState *s)
+{
+    uint64_t span = s->latest_us - s->first_us;
+    return span ? 100.0 * (double)s->bits * 1e6 / (double)span / bus_bitrate : 0.0;
+}
+
+static double mean_period_ms(const IdTiming *t)
+{
+    return t->frames > 1 ? (double)(t->last_us - t->first_us) / (t->frames - 1) / 1000.0 : 0.0;
+}
+
+static void format_id(char *out, size_t len, uint32_t id)
+{
+    if (id & CAN_EFF_FLAG)
+        snprintf(out, len, "0x%08X", id & CAN_EFF_MASK);
+    else
+        snprintf(out, len, "0x%03X", id);
+}
+
+int bus_analyzer_write_json(char *buf, size_t len)
+{
+    const BusState *s = take_snapshot();
+    char id[16];
+    int first = 1;
+
+    int off = snprintf(buf, len,
+                       "{\"bitrate\":%u,\"load_pct\":%.2f,\"peak_load_pct\":%.2f,\"avg_load_pct\":%.2f,"
+                       "\"frames_per_s\":%u,\"frames\":%llu,\"untracked\":%llu,\"ids\":[",
+                       bus_bitrate, load_percent(s->last_window_bits),
+                       load_percent(s->peak_window_bits), average_load_percent(s),
+                       s->last_window_frames, (unsigned long long)s->frames,
+                       (unsigned long long)s->untracked);
+
+    for (int i = 0; i < ID_SLOTS && off > 0 && (size_t)off < len; i++) {
+        const IdTiming *t = &s->ids[i];
+        if (t->id == ID_EMPTY)
+            continue;
+
+        format_id(id, sizeof(id), t->id);
+        off += snprintf(buf + off, len - off,
+                        "%s{\"id\":\"%s\",\"frames\":%llu,\"rate_hz\":%u,\"period_ms\":%.2f,"
+                        "\"jitter_ms\":%.3f,\"max_gap_ms\":%.2f,\"bits\":%.1f}",
+                        first ? "" : ",", id, (unsigned long long)t->frames, t->rate,
+                        mean_period_ms(t), t->jitter_us / 1000.0, t->max_gap_us / 1000.0,
+                        (double)t->bits / t->frames);
+        first = 0;
+    }
+
+    if (off > 0 && (size_t)off < len)
+        off += snprintf(buf + off, len - off, "]}");
+
+    return (off > 0 && (size_t)off < len) ? off : (int)(len ? len - 1 : 0);
+}
+
+int bus_analyzer_write_metrics(char *buf, size_t len)
+{
+    const BusState *s = take_snapshot();
+    char id[16];
+
+    int off = snprintf(buf, len,
+                       "# TYPE can_bus_load_percent gauge\n"
+                       "can_bus_load_percent %.2f\n"
+                       "# TYPE can_bus_load_peak_percent gauge\n"
+                       "can_bus_load_peak_percent %.2f\n"
+                       "# TYPE can_bus_frames_total counter\n"
+                       "can_bus_frames_total %llu\n"
+                       "# TYPE can_bus_bits_total counter\n"
+                       "can_bus_bits_total %llu\n"
+                       "# TYPE can_bus_untracked_frames_total counter\n"
+                       "can_bus_untracked_frames_total %llu\n"
+                       "# TYPE can_id_rate_hz gauge\n"
+                       "# TYPE can_id_period_ms gauge\n"
+                       "# TYPE can_id_jitter_ms gauge\n"
+                       "# TYPE can_id_max_gap_ms gauge\n",
+                       load_percent(s->last_window_bits), load_percent(s->peak_window_bits),
+                       (unsigned long long)s->frames, (unsigned long long)s->bits,
+                       (unsigned long long)s->untracked);
+
+    for (int i = 0; i < ID_SLOTS && off > 0 && (size_t)off < len; i++) {
+        const IdTiming *t = &s->ids[i];
+        if (t->id == ID_EMPTY)
+            continue;
+
+        format_id(id, sizeof(id), t->id);
+        off += snprintf(buf + off, len - off,
+                        "can_id_rate_hz{id=\"%s\"} %u\n"
+                        "can_id_period_ms{id=\"%s\"} %.2f\n"
+                        "can_id_jitter_ms{id=\"%s\"} %.3f\n"
+                        "can_id_max_gap_ms{id=\"%s\"} %.2f\n",
+                        id, t->rate,
+                        id, mean_period_ms(t),
+                        id, t->jitter_us / 1000.0,
+                        id, t->max_gap_us / 1000.0);
+    }
+
+    return (off > 0 && (size_t)off < len) ? off : (int)(len ? len - 1 : 0);
+}
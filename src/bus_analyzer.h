@@ -0,0 +1,44 @@
+#ifndef BUS_ANALYZER_H
+#define BUS_ANALYZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_message.h"
+
+/* Bus load and timing analysis of every frame put on the bus.
+ *
+ * Per CAN ID: frame count, rate over the last complete second, mean
+ * period, jitter and the longest gap between two frames. Jitter is the
+ * smoothed difference between consecutive periods (the RFC 3550
+ * interarrival estimator, gain 1/16), so no samples are stored.
+ *
+ * Bus utilization counts the exact length of each frame on the wire:
+ * its bit stream including the CRC is built and the stuff bits it needs
+ * are counted, plus delimiters, ACK, EOF and interframe space.
+ *
+ * Timing follows frame timestamps. Memory is fixed: up to BUS_MAX_IDS
+ * IDs are tracked, further ones only count towards the bus totals.
+ */
+
+#define BUS_MAX_IDS          256
+#define BUS_DEFAULT_BITRATE  500000
+#define BUS_WINDOW_US        1000000    /* Rate and load window */
+
+void bus_analyzer_init(uint32_t bitrate);
+
+/* Account one frame. Called by the single ingest thread. */
+void bus_analyzer_frame(const CAN_Message *msg);
+
+/* Bits a data frame occupies on the bus, stuff bits and interframe
+ * space included.
+ */
+int bus_frame_bits(const CAN_Message *msg);
+
+/* Writes bus load and per-ID timing as JSON. Returns bytes written. */
+int bus_analyzer_write_json(char *buf, size_t len);
+
+/* Same in Prometheus text format. Returns bytes written. */
+int bus_analyzer_write_metrics(char *buf, size_t len);
+
+#endif /* BUS_ANALYZER_H */
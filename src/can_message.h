@@ -2,15 +2,19 @@
 #define CAN_MESSAGE_H
 
 #include <stdint.h>
-#include <time.h>
+
+/* Extended (29-bit) frames carry CAN_EFF_FLAG in id, as in SocketCAN. */
+#define CAN_EFF_FLAG  0x80000000u
+#define CAN_EFF_MASK  0x1FFFFFFFu
+#define CAN_SFF_MASK  0x000007FFu
 
 /* Software representation of a CAN frame. */
 typedef struct
 {
-    uint16_t id;        /* CAN identifier (standard 11-bit ID) */
-    uint8_t  dlc;       /* Data Length Code (0–8 bytes) */
-    uint8_t  data[8];   /* CAN payload */
-    time_t   timestamp; /* Message generation or reception time */
+    uint32_t id;           /* Standard 11-bit ID, or 29-bit ID | CAN_EFF_FLAG */
+    uint8_t  dlc;          /* Data Length Code (0–8 bytes) */
+    uint8_t  data[8];      /* CAN payload */
+    uint64_t timestamp_us; /* Generation or reception time (µs since the Unix epoch) */
 } CAN_Message;
 
 /* Prints a CAN message, Parameter passed is the msg Pointer to the CAN_Message to be printed. */
@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <math.h>
+
+#include "compression.h"
+
+/* PER-CHANNEL STATE */
+
+typedef struct
+{
+    int            configured;
+    const char    *name;
+    CompressConfig cfg;
+    float          deviation;   /* Resolved error bound in physical units */
+
+    int            has_anchor;
+    CompressSample anchor;      /* Last forwarded sample */
+    int            has_held;
+    CompressSample held;        /* Last received sample not yet forwarded */
+
+    /* Swinging door: slopes from the upper/lower pivot (anchor +/- deviation) */
+    double         slope_upper;
+    double         slope_lower;
+
+    uint64_t       samples_in;
+    uint64_t       samples_out;
+} CompressState;
+
+static CompressState channels[COMPRESS_MAX_CHANNELS];
+
+static void open_door(CompressState *st)
+{
+    st->slope_upper = -INFINITY;
+    st->slope_lower = INFINITY;
+}
+
+/* Makes s the new anchor and queues it for the sinks. */
+static void forward(CompressState *st, const CompressSample *s, CompressSample *out, int *n)
+{
+    out[(*n)++] = *s;
+    st->anchor = *s;
+    st->has_anchor = 1;
+    st->has_held = 0;
+    open_door(st);
+}
+
+static double seconds_between(const CompressSample *a, const CompressSample *b)
+{
+    double dt = (double)(b->time_us - a->time_us) / 1e6;
+    return dt > 0.0 ? dt : 1e-6;
+}
+
+/* Returns 1 if the segment anchor -> s stays within the deviation of
+ * every point seen since the anchor, i.e. its slope is inside the door. */
+static int inside_door(const CompressState *st, const CompressSample *s)
+{
+    double slope = (s->value - st->anchor.value) / seconds_between(&st->anchor, s);
+    return slope >= st->slope_upper && slope <= st->slope_lower;
+}
+
+/* Narrows the door by the slopes from the upper/lower pivot to s. */
+static void swing_door(CompressState *st, const CompressSample *s)
+{
+    double dt = seconds_between(&st->anchor, s);
+    double upper = (s->value - (st->anchor.value + st->deviation)) / dt;
+    double lower = (s->value - (st->anchor.value - st->deviation)) / dt;
+
+    if (upper > st->slope_upper)
+        st->slope_upper = upper;
+    if (lower < st->slope_lower)
+        st->slope_lower = lower;
+}
+
+static int interval_elapsed(const CompressState *st, const CompressSample *s)
+{
+    return st->cfg.max_interval_ms &&
+           s->time_us - st->anchor.time_us >= (uint64_t)st->cfg.max_interval_ms * 1000u;
+}
+
+/* PUBLIC API */
+
+void compression_configure(int channel,
+                           const char *signal_name,
+                           const CompressConfig *cfg,
+                           float range)
+{
+    if (channel < 0 || channel >= COMPRESS_MAX_CHANNELS)
+        return;
+
+    CompressState *st = &channels[channel];
+
+    st->configured = 1;
+    st->name       = signal_name;
+    st->cfg        = *cfg;
+    st->deviation  = (cfg->mode == COMPRESS_DEADBAND_PERCENT)
+                   ? cfg->deviation * range / 100.0f
+                   : cfg->deviation;
+    st->has_anchor = 0;
+    st->has_held   = 0;
+    open_door(st);
+}
+
+int compression_filter(int channel, const CompressSample *in, CompressSample *out)
+{
+    int n = 0;
+
+    if (channel < 0 || channel >= COMPRESS_MAX_CHANNELS || !channels[channel].configured) {
+        out[n++] = *in;
+        return n;
+    }
+
+    CompressState *st = &channels[channel];
+    st->samples_in++;
+
+    if (!st->has_anchor || st->cfg.mode == COMPRESS_NONE) {
+        forward(st, in, out, &n);
+    }
+    else if (st->cfg.mode == COMPRESS_SWINGING_DOOR) {
+        const CompressSample *last = st->has_held ? &st->held : &st->anchor;
+
+        if (in->warning != last->warning) {
+            /* Keep both sides of a warning transition. */
+            if (st->has_held)
+                forward(st, &st->held, out, &n);
+            forward(st, in, out, &n);
+        }
+        else {
+            if (st->has_held && !inside_door(st, in)) {
+                /* Door closed: the held point ends the segment, restart from it. */
+                CompressSample held = st->held;
+                forward(st, &held, out, &n);
+            }
+
+            swing_door(st, in);
+            st->held = *in;
+            st->has_held = 1;
+
+            if (interval_elapsed(st, in))
+                forward(st, in, out, &n);
+        }
+    }
+    else {
+        /* Absolute or percent deadband */
+        if (fabsf(in->value - st->anchor.value) > st->deviation ||
+            in->warning != st->anchor.warning ||
+            interval_elapsed(st, in))
+            forward(st, in, out, &n);
+    }
+
+    st->samples_out += n;
+    return n;
+}
+
+int compression_write_metrics(char *buf, size_t len)
+{
+    uint64_t total_in = 0, total_out = 0;
+    int off = snprintf(buf, len,
+                       "# TYPE can_compress_samples_in_total counter\n"
+                       "# TYPE can_compress_samples_out_total counter\n"
+                       "# TYPE can_compress_ratio gauge\n");
+
+    for (int i = 0; i < COMPRESS_MAX_CHANNELS && off > 0 && (size_t)off < len; i++) {
+        const CompressState *st = &channels[i];
+        if (!st->configured)
+            continue;
+
+        total_in  += st->samples_in;
+        total_out += st->samples_out;
+
+        off += snprintf(buf + off, len - off,
+                        "can_compress_samples_in_total{signal=\"%s\"} %llu\n"
+                        "can_compress_samples_out_total{signal=\"%s\"} %llu\n"
+                        "can_compress_ratio{signal=\"%s\"} %.2f\n",
+                        st->name, (unsigned long long)st->samples_in,
+                        st->name, (unsigned long long)st->samples_out,
+                        st->name, st->samples_out ? (double)st->samples_in / st->samples_out : 1.0);
+    }
+
+    if (off > 0 && (size_t)off < len) {
+        off += snprintf(buf + off, len - off, "can_compress_ratio{signal=\"all\"} %.2f\n",
+                        total_out ? (double)total_in / total_out : 1.0);
+    }
+
+    return (off > 0 && (size_t)off < len) ? off : (int)(len ? len - 1 : 0);
+}
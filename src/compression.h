@@ -0,0 +1,56 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "can_message.h"
+#include "signal_registry.h"
+
+/* Per-signal sample compression between decoding and the sinks
+ * (log file, publishers). The live data model always keeps the
+ * latest value; only what is forwarded to sinks is thinned out.
+ */
+
+typedef enum {
+    COMPRESS_NONE = 0,          /* Forward every sample */
+    COMPRESS_DEADBAND_ABS,      /* Forward when |v - last| > deviation */
+    COMPRESS_DEADBAND_PERCENT,  /* Same, deviation in percent of the signal range */
+    COMPRESS_SWINGING_DOOR      /* Swinging-door trending, error bound = deviation */
+} CompressMode;
+
+/* Per-signal configuration, part of the signal definition. */
+typedef struct {
+    CompressMode mode;
+    float        deviation;        /* Error bound in physical units (percent for DEADBAND_PERCENT) */
+    uint32_t     max_interval_ms;  /* Forward at least once per interval, 0 = no limit */
+} CompressConfig;
+
+/* A decoded sample together with the frame it came from. */
+typedef struct {
+    CAN_Message frame;
+    float       value;
+    int         warning;
+    uint64_t    time_us;
+} CompressSample;
+
+#define COMPRESS_MAX_CHANNELS MAX_SIGNALS   /* Channels are signal handles */
+#define COMPRESS_MAX_OUT      2   /* A sample can release a held point plus itself */
+
+/* Configure a signal's channel. range is max - min of the signal. */
+void compression_configure(int channel,
+                           const char *signal_name,
+                           const CompressConfig *cfg,
+                           float range);
+
+/* Feed one sample. Samples to forward are written to out, oldest first.
+ * Returns the number of samples written (0..COMPRESS_MAX_OUT).
+ */
+int compression_filter(int channel, const CompressSample *in, CompressSample *out);
+
+/* Writes per-signal input/output counts and reduction ratios
+ * in Prometheus text format. Returns bytes written.
+ */
+int compression_write_metrics(char *buf, size_t len);
+
+#endif /* COMPRESSION_H */
@@ -0,0 +1,244 @@
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "console.h"
+#include "data_model.h"
+#include "platform.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#define SLEEP_MS(ms) Sleep(ms)
+#else
+#include <unistd.h>
+#define SLEEP_MS(ms) usleep((ms) * 1000)
+#endif
+
+#define MESSAGE_LEN      128
+#define RECENT_MESSAGES  5      /* Shown below the table */
+#define MAX_SAMPLES      32     /* Sampled frames per refresh (verbose) */
+
+/* CONSOLE STATE */
+
+static ConsoleConfig     config;
+static int               running = 0;
+static platform_thread_t console_tid;
+static platform_mutex_t  lock;
+
+/* Written by the decode thread only, read by the console thread without
+ * the lock: relaxed atomics, so neither a race nor a torn 64-bit count.
+ */
+static _Atomic uint64_t frames;
+static _Atomic uint64_t updates[MAX_SIGNALS];
+static _Atomic uint64_t range_errors[MAX_SIGNALS];
+
+/* Increments a counter only its own thread writes. */
+static uint64_t bump(_Atomic uint64_t *counter)
+{
+    uint64_t n = atomic_load_explicit(counter, memory_order_relaxed) + 1;
+    atomic_store_explicit(counter, n, memory_order_relaxed);
+    return n;
+}
+
+/* Shared with every thread reporting events, under lock */
+static uint64_t    events[CONSOLE_EVENT_COUNT];
+static char        pending[CONSOLE_MESSAGES_PER_REFRESH][MESSAGE_LEN];
+static int         pending_count;
+static uint64_t    pending_dropped;
+static CAN_Message samples[MAX_SAMPLES];
+static int         sample_count;
+
+/* Console thread only */
+static char     recent[RECENT_MESSAGES][MESSAGE_LEN];
+static int      recent_next;
+static uint64_t last_frames;
+
+/* DRAWING (console thread) */
+
+static void draw_table(const uint64_t *event_counts, uint64_t dropped, int hz)
+{
+    uint64_t total = atomic_load_explicit(&frames, memory_order_relaxed);
+    uint64_t rate = (total - last_frames) * (uint64_t)hz;
+    last_frames = total;
+
+    /* Home the cursor and clear, then draw in one go. */
+    printf("\033[H\033[J");
+    printf("CAN LIVE VIEW   frames %llu (%llu/s)   unknown %llu   dlc %llu   e2e %llu   range %llu\n\n",
+           (unsigned long long)total, (unsigned long long)rate,
+           (unsigned long long)event_counts[CONSOLE_EVENT_UNKNOWN_ID],
+           (unsigned long long)event_counts[CONSOLE_EVENT_DLC],
+           (unsigned long long)event_counts[CONSOLE_EVENT_E2E],
+           (unsigned long long)event_counts[CONSOLE_EVENT_RANGE]);
+    printf("%-22s %12s %-5s %-8s %10s %8s\n", "SIGNAL", "VALUE", "UNIT", "STATE", "UPDATES", "RANGE");
+
+    for (int h = 0; h < signal_count(); h++) {
+        const SignalInfo *info = signal_info((SignalHandle)h);
+        uint8_t flags = g_vehicle_data.flags[h];
+        uint64_t count = atomic_load_explicit(&updates[h], memory_order_relaxed);
+        uint64_t range = atomic_load_explicit(&range_errors[h], memory_order_relaxed);
+        const char *state = (flags & SIGNAL_FLAG_STALE)   ? "NO DATA" :
+                            (flags & SIGNAL_FLAG_WARNING) ? "WARNING" :
+                            count                         ? "OK" : "-";
+
+        printf("%-22s %12.2f %-5s %-8s %10llu %8llu\n",
+               info->name, g_vehicle_data.values[h], info->unit, state,
+               (unsigned long long)count, (unsigned long long)range);
+    }
+
+    printf("\nLatest messages%s\n", dropped ? " (some omitted)" : "");
+    for (int i = 0; i < RECENT_MESSAGES; i++) {
+        const char *line = recent[(recent_next + i) % RECENT_MESSAGES];
+        if (line[0])
+            printf("  %s\n", line);
+    }
+}
+
+static void *console_thread(void *arg)
+{
+    (void)arg;
+    char        lines[CONSOLE_MESSAGES_PER_REFRESH][MESSAGE_LEN];
+    CAN_Message sampled[MAX_SAMPLES];
+    uint64_t    event_counts[CONSOLE_EVENT_COUNT];
+
+    while (1) {
+        SLEEP_MS(1000 / config.refresh_hz);
+
+        /* Take what the other threads left, then print without the lock. */
+        platform_mutex_lock(&lock);
+        int line_count = pending_count;
+        int sample_total = sample_count;
+        uint64_t dropped = pending_dropped;
+        memcpy(lines, pending, sizeof(lines[0]) * (size_t)line_count);
+        memcpy(sampled, samples, sizeof(sampled[0]) * (size_t)sample_total);
+        memcpy(event_counts, events, sizeof(event_counts));
+        pending_count = 0;
+        pending_dropped = 0;
+        sample_count = 0;
+        platform_mutex_unlock(&lock);
+
+        if (config.mode == CONSOLE_TABLE) {
+            for (int i = 0; i < line_count; i++) {
+                memcpy(recent[recent_next], lines[i], MESSAGE_LEN);
+                recent_next = (recent_next + 1) % RECENT_MESSAGES;
+            }
+            draw_table(event_counts, dropped, config.refresh_hz);
+        }
+        else {
+            for (int i = 0; i < sample_total; i++)
+                print_can_message(&sampled[i]);
+            for (int i = 0; i < line_count; i++)
+                printf("%s\n", lines[i]);
+            if (dropped)
+                printf("... %llu more message(s)\n", (unsigned long long)dropped);
+        }
+
+        fflush(stdout);
+    }
+
+    return NULL;
+}
+
+/* PUBLIC API */
+
+void console_default_config(ConsoleConfig *cfg)
+{
+    cfg->mode         = CONSOLE_TABLE;
+    cfg->refresh_hz   = CONSOLE_DEFAULT_HZ;
+    cfg->sample_every = CONSOLE_DEFAULT_SAMPLE;
+}
+
+int console_parse_mode(const char *text, ConsoleMode *mode)
+{
+    if (strcmp(text, "table") == 0)
+        *mode = CONSOLE_TABLE;
+    else if (strcmp(text, "verbose") == 0)
+        *mode = CONSOLE_VERBOSE;
+    else
+        return -1;
+    return 0;
+}
+
+int console_start(const ConsoleConfig *cfg)
+{
+    config = *cfg;
+    if (config.refresh_hz <= 0 || config.refresh_hz > 1000)
+        config.refresh_hz = CONSOLE_DEFAULT_HZ;
+    if (config.sample_every == 0)
+        config.sample_every = 1;
+
+#ifdef _WIN32
+    /* Let the table redraw with ANSI escapes. */
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD out_mode;
+    if (GetConsoleMode(out, &out_mode))
+        SetConsoleMode(out, out_mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
+
+    platform_mutex_init(&lock);
+    running = 1;
+
+    if (platform_thread_start(&console_tid, console_thread, NULL) < 0) {
+        running = 0;
+        printf("ERROR: Cannot start console thread\n");
+        return -1;
+    }
+    return 0;
+}
+
+void console_frame(const CAN_Message *msg)
+{
+    if (!running) {
+        print_can_message(msg);
+        return;
+    }
+
+    uint64_t n = bump(&frames);
+
+    if (config.mode == CONSOLE_VERBOSE && n % config.sample_every == 0) {
+        platform_mutex_lock(&lock);
+        if (sample_count < MAX_SAMPLES)
+            samples[sample_count++] = *msg;
+        platform_mutex_unlock(&lock);
+    }
+}
+
+void console_signal(SignalHandle handle, float value, int out_of_range)
+{
+    if (!running) {
+        const SignalInfo *info = signal_info(handle);
+        printf("Decoded | %s = %.2f %s\n", info->name, value, info->unit);
+        return;
+    }
+
+    if (handle < MAX_SIGNALS) {
+        bump(&updates[handle]);
+        if (out_of_range)
+            bump(&range_errors[handle]);
+    }
+}
+
+void console_event(ConsoleEvent kind, const char *fmt, ...)
+{
+    va_list args;
+
+    if (!running) {
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+        printf("\n");
+        return;
+    }
+
+    platform_mutex_lock(&lock);
+    events[kind]++;
+    if (pending_count < CONSOLE_MESSAGES_PER_REFRESH) {
+        va_start(args, fmt);
+        vsnprintf(pending[pending_count++], MESSAGE_LEN, fmt, args);
+        va_end(args);
+    }
+    else {
+        pending_dropped++;
+    }
+    platform_mutex_unlock(&lock);
+}
@@ -0,0 +1,71 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+
+#include "can_message.h"
+#include "signal_registry.h"
+
+/* Terminal output of the live path.
+ *
+ * The decode path only records into memory: frame and event counters,
+ * per-signal update counts, and (verbose mode) sampled frames and recent
+ * messages. A console thread started by console_start() does all the
+ * printing, at a fixed refresh rate:
+ *
+ *   CONSOLE_TABLE    redraw a compact table of every signal (latest
+ *                    value, flags, counters) plus the latest messages
+ *   CONSOLE_VERBOSE  print one frame in sample_every, and messages, as
+ *                    scrolling lines
+ *
+ * Before console_start() (test mode) everything is printed immediately,
+ * as before.
+ */
+
+#define CONSOLE_DEFAULT_HZ      10
+#define CONSOLE_DEFAULT_SAMPLE  10
+#define CONSOLE_MESSAGES_PER_REFRESH 8   /* Further messages are only counted */
+
+typedef enum
+{
+    CONSOLE_TABLE,
+    CONSOLE_VERBOSE
+} ConsoleMode;
+
+typedef enum
+{
+    CONSOLE_EVENT_INFO,
+    CONSOLE_EVENT_UNKNOWN_ID,
+    CONSOLE_EVENT_DLC,
+    CONSOLE_EVENT_E2E,
+    CONSOLE_EVENT_RANGE,
+    CONSOLE_EVENT_COUNT
+} ConsoleEvent;
+
+typedef struct
+{
+    ConsoleMode mode;
+    int         refresh_hz;
+    uint32_t    sample_every;   /* Verbose: print one frame in this many */
+} ConsoleConfig;
+
+void console_default_config(ConsoleConfig *cfg);
+
+/* "table" or "verbose". Returns 0 on success. */
+int console_parse_mode(const char *text, ConsoleMode *mode);
+
+/* Start the console thread. Returns 0 on success, -1 on failure. */
+int console_start(const ConsoleConfig *cfg);
+
+/* Record a frame entering the decoder. */
+void console_frame(const CAN_Message *msg);
+
+/* Record a decoded value of a signal. */
+void console_signal(SignalHandle handle, float value, int out_of_range);
+
+/* Count an event and keep (or, before console_start(), print) its
+ * printf-formatted message line.
+ */
+void console_event(ConsoleEvent kind, const char *fmt, ...);
+
+#endif /* CONSOLE_H */
@@ -6,10 +6,6 @@
  * and consumed by the application, UI, or logging layers.
  */
 VehicleData g_vehicle_data = {
-    .motor_rpm         = 0.0f,
-    .vehicle_speed     = 0.0f,
-    .battery_soc       = 0.0f,
-    .battery_voltage   = 0.0f,
-    .motor_temperature = 0.0f,
-
+    .values = { 0.0f },
+    .flags  = { 0 },
 };
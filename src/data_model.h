@@ -1,8 +1,11 @@
 #ifndef DATA_MODEL_H
 #define DATA_MODEL_H
 
+#include <stdatomic.h>
 #include <stdint.h>
 
+#include "signal_registry.h"
+
 /* Container for the latest decoded vehicle signals. 
  * This structure holds processed CAN data in physical units,
  * updated by the CAN parser and consumed by the dashboard layer.
@@ -35,20 +38,17 @@ typedef struct {
     int        count;
 } TestDashboardData;
 
+/* Per-signal status flags */
+#define SIGNAL_FLAG_WARNING  0x01   /* Value outside the signal's min/max */
+#define SIGNAL_FLAG_STALE    0x02   /* Message overdue (see supervision.h) */
+
 typedef struct
 {
-    /* Live Decoded Signals */
-    float motor_rpm;          /* Motor speed in RPM */
-    float vehicle_speed;      /* Vehicle speed */
-    float battery_soc;        /* Battery state of charge (%) */
-    float battery_voltage;    /* Battery voltage */
-    float motor_temperature;  /* Motor temperature */
-    /* Runtime Warnings */
-    int rpm_warning;
-    int speed_warning;
-    int soc_warning;
-    int voltage_warning;
-    int temp_warning;
+    /* Live Decoded Signals, indexed by SignalHandle */
+    float   values[MAX_SIGNALS];  /* Latest physical value */
+    /* SIGNAL_FLAG_*, set and cleared with atomic fetch-or/fetch-and:
+     * the decode thread owns WARNING, the supervision thread STALE. */
+    _Atomic uint8_t flags[MAX_SIGNALS];
     int mode;
     TestDashboardData test_dashboard;
     
@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "decoder_fuzz.h"
+#include "parser.h"
+#include "platform.h"
+
+#define FUZZ_MAX_THREADS  64
+#define FUZZ_BATCH        4096   /* Cases generated, decoded and checked at a time */
+#define FUZZ_MAX_PAYLOAD  64     /* CAN FD frame */
+#define FUZZ_MAX_REPORTS  8      /* Mismatches printed in detail */
+
+typedef struct
+{
+    SignalDef def;
+    uint8_t   len;              /* Payload length received, usually def.dlc */
+    uint8_t   data[FUZZ_MAX_PAYLOAD];
+} FuzzCase;
+
+/* What decode_signal() gives for a case. */
+typedef struct
+{
+    int     rc;                 /* 0 or DECODE_DLC_MISMATCH */
+    int64_t raw;
+    float   value;
+    int     out_of_range;
+} FuzzOutcome;
+
+/* What the reference expects. The value is exact in double precision;
+ * the decoder works in float, so it may be off by up to tolerance.
+ */
+typedef struct
+{
+    int     rc;
+    int64_t raw;
+    double  value;
+    double  tolerance;
+    int     out_of_range;
+    int     near_limit;         /* value within tolerance of min or max */
+} FuzzExpected;
+
+/* Work and results of one thread. */
+typedef struct
+{
+    uint64_t cases;
+    uint64_t rng;
+    uint64_t mismatches;
+    uint64_t decode_us;
+    uint64_t reference_us;
+    FuzzCase    batch[FUZZ_BATCH];
+    FuzzOutcome  got[FUZZ_BATCH];
+    FuzzExpected expected[FUZZ_BATCH];
+} FuzzWorker;
+
+static platform_mutex_t report_lock;
+static int              reported;
+
+/* splitmix64 */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/* REFERENCE DECODER
+ * One bit at a time, straight from the layout rules in parser.h.
+ */
+static int64_t reference_extract(const uint8_t *data, const SignalLayout *layout)
+{
+    uint64_t raw = 0;
+    uint64_t mask = (1ull << layout->bit_length) - 1;
+
+    for (int i = 0; i < layout->bit_length; i++) {
+        int pos = layout->start_bit + i;
+
+        if (layout->byte_order == SIGNAL_LITTLE_ENDIAN) {
+            /* Bit i of the value is bit pos counted from the LSB of byte 0 */
+            uint64_t bit = (data[pos / 8] >> (pos % 8)) & 1;
+            raw |= bit << i;
+        }
+        else {
+            /* Most significant bit first, counted from the MSB of byte 0 */
+            uint64_t bit = (data[pos / 8] >> (7 - pos % 8)) & 1;
+            raw = (raw << 1) | bit;
+        }
+    }
+
+    /* Negative values carry ones in every bit above the signal */
+    if (layout->is_signed && (raw & (1ull << (layout->bit_length - 1))))
+        raw |= ~mask;
+
+    return (int64_t)raw;
+}
+
+static double magnitude(double x)
+{
+    return x < 0.0 ? -x : x;
+}
+
+/* Physical value in double precision, with the error bound of the float
+ * arithmetic the decoder is allowed: rounding the raw value, the product
+ * and the sum, one float ulp (2^-24 relative) each.
+ */
+static void reference_decode(const FuzzCase *c, FuzzExpected *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    if (c->len != c->def.dlc) {
+        out->rc = DECODE_DLC_MISMATCH;
+        return;
+    }
+
+    out->raw = reference_extract(c->data, &c->def.layout);
+
+    double product = (double)out->raw * (double)c->def.scale;
+    out->value     = product + (double)c->def.offset;
+    out->tolerance = (2.0 * magnitude(product) + magnitude(out->value)) * 0x1.002p-24;
+
+    out->out_of_range = out->value < c->def.min || out->value > c->def.max;
+    out->near_limit   = magnitude(out->value - c->def.min) <= out->tolerance ||
+                        magnitude(out->value - c->def.max) <= out->tolerance;
+}
+
+/* TEST CASES */
+
+static const float scales[]  = { 1.0f, 0.1f, 0.01f, 0.001f, 0.5f, 0.25f, 2.0f, 10.0f };
+static const float offsets[] = { 0.0f, -40.0f, -1000.0f, 100.5f, -0.5f, 273.15f, -32768.0f, 1e6f };
+
+static void random_case(FuzzCase *c, uint64_t *rng)
+{
+    uint64_t r = next_random(rng);
+    int len = 1 + (int)(r % FUZZ_MAX_PAYLOAD);
+    int bits = 8 * len;
+    int max_length = bits < SIGNAL_MAX_BITS ? bits : SIGNAL_MAX_BITS;
+
+    SignalLayout *layout = &c->def.layout;
+
+    r /= FUZZ_MAX_PAYLOAD;
+    layout->bit_length = (uint8_t)(1 + r % (uint64_t)max_length);
+    r /= (uint64_t)max_length;
+    layout->start_bit  = (uint16_t)(r % (uint64_t)(bits - layout->bit_length + 1));
+
+    r = next_random(rng);
+    layout->byte_order = (r & 1) ? SIGNAL_LITTLE_ENDIAN : SIGNAL_BIG_ENDIAN;
+    layout->is_signed  = (uint8_t)((r >> 1) & 1);
+    c->def.dlc    = (uint16_t)len;
+    c->def.scale  = scales[(r >> 2) & 7];
+    c->def.offset = offsets[(r >> 5) & 7];
+    c->def.min    = (float)((int)((r >> 8) & 0xFFFF) - 32768);
+    c->def.max    = c->def.min + (float)((r >> 24) & 0xFFFF);
+
+    /* One frame in 16 arrives with another length and must be rejected. */
+    c->len = (uint8_t)len;
+    if (((r >> 40) & 15) == 0)
+        c->len = (uint8_t)(1 + (len + (int)((r >> 44) % (FUZZ_MAX_PAYLOAD - 1))) % FUZZ_MAX_PAYLOAD);
+
+    for (int i = 0; i < len; i += 8) {
+        r = next_random(rng);
+        memcpy(&c->data[i], &r, (size_t)(len - i < 8 ? len - i : 8));
+    }
+}
+
+static int outcome_ok(const FuzzCase *c, const FuzzExpected *expected, const FuzzOutcome *got)
+{
+    if (got->rc != expected->rc)
+        return 0;
+    if (got->rc != 0)
+        return 1;
+    if (got->raw != expected->raw ||
+        !(magnitude((double)got->value - expected->value) <= expected->tolerance))
+        return 0;
+
+    /* Close to a limit, rounding decides: the flag must then match the
+     * value the decoder reported.
+     */
+    if (expected->near_limit)
+        return got->out_of_range == (got->value < c->def.min || got->value > c->def.max);
+    return got->out_of_range == expected->out_of_range;
+}
+
+static void report_mismatch(const FuzzCase *c, const FuzzExpected *expected, const FuzzOutcome *got)
+{
+    platform_mutex_lock(&report_lock);
+
+    if (reported++ < FUZZ_MAX_REPORTS) {
+        const SignalLayout *layout = &c->def.layout;
+
+        printf("MISMATCH: %s %s start_bit=%u bit_length=%u dlc=%u scale=%g offset=%g "
+               "min=%g max=%g len=%u payload=[",
+               layout->byte_order == SIGNAL_LITTLE_ENDIAN ? "little-endian" : "big-endian",
+               layout->is_signed ? "signed" : "unsigned",
+               layout->start_bit, layout->bit_length, c->def.dlc, c->def.scale,
+               c->def.offset, c->def.min, c->def.max, c->len);
+        for (int i = 0; i < c->len; i++)
+            printf(i ? " %02X" : "%02X", c->data[i]);
+        printf("] expected rc=%d raw=%lld value=%.9g (+/-%.3g) range=%d, "
+               "decoded rc=%d raw=%lld value=%.9g range=%d\n",
+               expected->rc, (long long)expected->raw, expected->value, expected->tolerance,
+               expected->out_of_range,
+               got->rc, (long long)got->raw, got->value, got->out_of_range);
+    }
+
+    platform_mutex_unlock(&report_lock);
+}
+
+static void *fuzz_thread(void *arg)
+{
+    FuzzWorker *w = arg;
+    uint64_t left = w->cases;
+
+    while (left > 0) {
+        int n = left < FUZZ_BATCH ? (int)left : FUZZ_BATCH;
+
+        for (int i = 0; i < n; i++)
+            random_case(&w->batch[i], &w->rng);
+
+        DecodedSignal d;
+        memset(&d, 0, sizeof(d));
+
+        uint64_t t0 = platform_time_us();
+        for (int i = 0; i < n; i++) {
+            const FuzzCase *c = &w->batch[i];
+
+            w->got[i].rc           = decode_signal(&c->def, c->data, c->len, &d);
+            w->got[i].raw          = d.raw;
+            w->got[i].value        = d.value;
+            w->got[i].out_of_range = d.out_of_range;
+        }
+        uint64_t t1 = platform_time_us();
+        for (int i = 0; i < n; i++)
+            reference_decode(&w->batch[i], &w->expected[i]);
+        uint64_t t2 = platform_time_us();
+
+        w->decode_us    += t1 - t0;
+        w->reference_us += t2 - t1;
+
+        /* The raw value is compared too: large ones lose bits as float. */
+        for (int i = 0; i < n; i++) {
+            if (!outcome_ok(&w->batch[i], &w->expected[i], &w->got[i])) {
+                w->mismatches++;
+                report_mismatch(&w->batch[i], &w->expected[i], &w->got[i]);
+            }
+        }
+
+        left -= (uint64_t)n;
+    }
+
+    return NULL;
+}
+
+/* PUBLIC API */
+
+int decoder_fuzz_run(const DecoderFuzzOptions *opts, DecoderFuzzResult *result)
+{
+    int threads = opts->threads > 0 ? opts->threads : platform_cpu_count();
+    if (threads > FUZZ_MAX_THREADS)
+        threads = FUZZ_MAX_THREADS;
+
+    FuzzWorker *workers = calloc((size_t)threads, sizeof(FuzzWorker));
+    platform_thread_t tids[FUZZ_MAX_THREADS];
+    if (!workers) {
+        printf("ERROR: Cannot allocate decoder test buffers\n");
+        return -1;
+    }
+
+    platform_mutex_init(&report_lock);
+    reported = 0;
+
+    for (int i = 0; i < threads; i++) {
+        workers[i].cases = opts->cases / (uint64_t)threads +
+                           ((uint64_t)i < opts->cases % (uint64_t)threads ? 1 : 0);
+        workers[i].rng   = ((uint64_t)opts->seed << 32) ^ (uint64_t)i * 0xD1B54A32D192ED03ull;
+    }
+
+    uint64_t start_us = platform_time_us();
+
+    int started = 0;
+    for (; started < threads; started++) {
+        if (platform_thread_start(&tids[started], fuzz_thread, &workers[started]) < 0) {
+            /* Fall back to running the rest on this thread. */
+            for (int i = started; i < threads; i++)
+                fuzz_thread(&workers[i]);
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++)
+        platform_thread_join(tids[i]);
+
+    memset(result, 0, sizeof(*result));
+    result->threads = threads;
+    result->wall_s  = (platform_time_us() - start_us) / 1e6;
+    for (int i = 0; i < threads; i++) {
+        result->cases       += workers[i].cases;
+        result->mismatches  += workers[i].mismatches;
+        result->decode_s    += workers[i].decode_us / 1e6;
+        result->reference_s += workers[i].reference_us / 1e6;
+    }
+
+    free(workers);
+    return result->mismatches ? -1 : 0;
+}
+
+void decoder_fuzz_print(const DecoderFuzzResult *result)
+{
+    printf("Decoder differential test: %llu cases on %d thread(s) in %.3f s, %llu mismatch(es)\n",
+           (unsigned long long)result->cases, result->threads, result->wall_s,
+           (unsigned long long)result->mismatches);
+
+    if (result->decode_s > 0.0 && result->reference_s > 0.0) {
+        printf("  decoder    %8.1f M signals/s per thread (%.2f ns per signal)\n",
+               (double)result->cases / result->decode_s / 1e6,
+               result->decode_s * 1e9 / (double)result->cases);
+        printf("  reference  %8.1f M signals/s per thread (%.2f ns per signal)\n",
+               (double)result->cases / result->reference_s / 1e6,
+               result->reference_s * 1e9 / (double)result->cases);
+    }
+}
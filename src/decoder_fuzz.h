@@ -0,0 +1,47 @@
+#ifndef DECODER_FUZZ_H
+#define DECODER_FUZZ_H
+
+#include <stdint.h>
+
+/* Randomized differential test of the signal decoder.
+ *
+ * Each case is a random payload (1 to 64 bytes) and a random signal
+ * definition for it: start bit, length (1 to SIGNAL_MAX_BITS), byte
+ * order, signedness, scale, offset and limits; one frame in 16 has the
+ * wrong length. decode_signal(), the per-signal step of the production
+ * decoder, is checked against a bit-by-bit reference of the same rules:
+ * DLC verdict and raw value must be equal, the physical value within
+ * float rounding of the reference's double result, and the range flag
+ * must agree with it.
+ *
+ * Cases are generated, decoded and checked in batches on every thread;
+ * only the decoding of a batch is timed, so the reported throughput is
+ * the decoder's own. A run is reproduced by its seed and thread count.
+ */
+
+typedef struct
+{
+    uint64_t cases;
+    int      threads;       /* 0 uses one thread per CPU */
+    uint32_t seed;
+} DecoderFuzzOptions;
+
+typedef struct
+{
+    uint64_t cases;
+    uint64_t mismatches;
+    int      threads;
+    double   decode_s;      /* Time in decode_signal(), all threads */
+    double   reference_s;   /* Time in the reference, all threads */
+    double   wall_s;
+} DecoderFuzzResult;
+
+/* Run the test. The first mismatches are printed as they are found.
+ * Returns 0 if every case matched, -1 otherwise.
+ */
+int decoder_fuzz_run(const DecoderFuzzOptions *opts, DecoderFuzzResult *result);
+
+/* Print a one-paragraph summary of a run. */
+void decoder_fuzz_print(const DecoderFuzzResult *result);
+
+#endif /* DECODER_FUZZ_H */
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "delta_protocol.h"
+#include "data_model.h"
+#include "signal_registry.h"
+
+/* CHANGE TRACKING
+ * The wire index of a signal is its registry handle. Values are compared
+ * against the last snapshot whenever a frame is requested; changed
+ * signals are stamped with the next sequence number.
+ */
+
+static uint32_t current_seq = 0;
+static uint32_t changed_seq[MAX_SIGNALS];
+static float    last_value[MAX_SIGNALS];
+static uint8_t  last_flags[MAX_SIGNALS];
+
+static void track_changes(void)
+{
+    int changed = 0;
+    int count = signal_count();
+
+    for (int i = 0; i < count; i++) {
+        float   v = g_vehicle_data.values[i];
+        uint8_t f = g_vehicle_data.flags[i];
+
+        if (v != last_value[i] || f != last_flags[i]) {
+            last_value[i]   = v;
+            last_flags[i]   = f;
+            changed_seq[i]  = current_seq + 1;
+            changed = 1;
+        }
+    }
+
+    if (changed)
+        current_seq++;
+}
+
+/* FNV-1a over names and units, so clients notice a changed signal list. */
+static uint32_t schema_id(void)
+{
+    uint32_t h = 2166136261u;
+
+    for (int i = 0; i < signal_count(); i++) {
+        const SignalInfo *info = signal_info((SignalHandle)i);
+        const char *parts[2] = { info->key, info->unit };
+        for (int p = 0; p < 2; p++) {
+            for (const char *c = parts[p]; ; c++) {
+                h = (h ^ (uint8_t)*c) * 16777619u;
+                if (*c == '\0')
+                    break;
+            }
+        }
+    }
+    return h;
+}
+
+/* LITTLE-ENDIAN WRITERS */
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+    return p + 4;
+}
+
+/* PUBLIC API */
+
+int delta_protocol_write_schema(char *buf, size_t len)
+{
+    int off = snprintf(buf, len, "{\"version\":%d,\"schema_id\":%lu,\"signals\":[",
+                       DELTA_VERSION, (unsigned long)schema_id());
+
+    int count = signal_count();
+
+    for (int i = 0; i < count && off > 0 && (size_t)off < len; i++) {
+        const SignalInfo *info = signal_info((SignalHandle)i);
+        off += snprintf(buf + off, len - off,
+                        "{\"index\":%d,\"name\":\"%s\",\"label\":\"%s\","
+                        "\"unit\":\"%s\",\"min\":%g,\"max\":%g}%s",
+                        i, info->key, info->label, info->unit, info->min, info->max,
+                        (i < count - 1) ? "," : "");
+    }
+
+    if (off > 0 && (size_t)off < len)
+        off += snprintf(buf + off, len - off, "]}");
+
+    return (off > 0 && (size_t)off < len) ? off : -1;
+}
+
+int delta_protocol_write_frame(uint32_t since, uint8_t *buf, size_t len)
+{
+    int signals = signal_count();
+
+    if (len < DELTA_HEADER_SIZE + (size_t)signals * DELTA_ENTRY_SIZE)
+        return -1;
+
+    track_changes();
+
+    int keyframe = (since == 0 || since > current_seq);
+    uint8_t flags = keyframe ? DELTA_FLAG_KEYFRAME : 0;
+    if (g_vehicle_data.mode == MODE_TEST)
+        flags |= DELTA_FLAG_TEST_MODE;
+
+    uint8_t *p = buf + DELTA_HEADER_SIZE;
+    uint16_t count = 0;
+
+    for (int i = 0; i < signals; i++) {
+        if (!keyframe && changed_seq[i] <= since)
+            continue;
+
+        uint32_t bits;
+        memcpy(&bits, &last_value[i], sizeof(bits));
+
+        p = put_u16(p, (uint16_t)i);
+        *p++ = last_flags[i];
+        p = put_u32(p, bits);
+        count++;
+    }
+
+    uint8_t *h = buf;
+    h = put_u16(h, DELTA_MAGIC);
+    *h++ = DELTA_VERSION;
+    *h++ = flags;
+    h = put_u32(h, schema_id());
+    h = put_u32(h, current_seq);
+    put_u16(h, count);
+
+    return (int)(p - buf);
+}
@@ -0,0 +1,42 @@
+#ifndef DELTA_PROTOCOL_H
+#define DELTA_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Compact binary update protocol served at /data.bin.
+ *
+ * Clients fetch the schema once (/schema, JSON) and then poll
+ * /data.bin?since=<seq>, passing back the seq of the last frame they
+ * applied. Each frame carries only the signals that changed after that
+ * sequence number. All fields are little-endian:
+ *
+ *   u16 magic      DELTA_MAGIC
+ *   u8  version    DELTA_VERSION
+ *   u8  flags      DELTA_FLAG_*
+ *   u32 schema_id  changes whenever the signal list changes
+ *   u32 seq        sequence number to pass back as since=
+ *   u16 count      number of entries that follow
+ *   count x { u16 index, u8 flags (SIGNAL_FLAG_*), f32 value }
+ */
+
+#define DELTA_MAGIC          0xCA7Du
+#define DELTA_VERSION        1
+#define DELTA_HEADER_SIZE    14
+#define DELTA_ENTRY_SIZE     7
+
+#define DELTA_FLAG_KEYFRAME  0x01  /* Frame contains every signal */
+#define DELTA_FLAG_TEST_MODE 0x02  /* Test mode active, use /data for results */
+
+/* Writes the schema (signal index, name, label, unit, limits) as JSON.
+ * Returns the number of bytes written, or -1 if buf is too small.
+ */
+int delta_protocol_write_schema(char *buf, size_t len);
+
+/* Encodes a frame with every signal changed after sequence number since.
+ * since = 0, or a value newer than the server knows, yields a keyframe.
+ * Returns the frame length, or -1 if buf is too small.
+ */
+int delta_protocol_write_frame(uint32_t since, uint8_t *buf, size_t len);
+
+#endif /* DELTA_PROTOCOL_H */
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "e2e.h"
+
+#define E2E_MAX_IDS      0x800
+#define E2E_COUNTER_MOD  16
+#define E2E_RESULT_COUNT 5   /* Counted per ID: all but E2E_ERR_UNKNOWN_ID */
+
+static const char *result_names[E2E_RESULT_COUNT + 1] = {
+    "ok", "ok_some_lost", "crc", "repeated", "wrong_sequence", "unknown_id"
+};
+
+typedef struct
+{
+    const char *name;
+    int         registered;
+    int         have_counter;
+    uint8_t     last_counter;
+    uint64_t    results[E2E_RESULT_COUNT];
+} E2EState;
+
+static uint8_t  crc8_table[256];
+static uint16_t crc16_table[256];
+static E2EState states[E2E_MAX_IDS];
+
+/* CRC */
+
+void e2e_init(void)
+{
+    for (int i = 0; i < 256; i++) {
+        uint8_t c8 = (uint8_t)i;
+        uint16_t c16 = (uint16_t)(i << 8);
+
+        for (int bit = 0; bit < 8; bit++) {
+            c8  = (c8 & 0x80) ? (uint8_t)((c8 << 1) ^ 0x1D) : (uint8_t)(c8 << 1);
+            c16 = (c16 & 0x8000) ? (uint16_t)((c16 << 1) ^ 0x1021) : (uint16_t)(c16 << 1);
+        }
+        crc8_table[i]  = c8;
+        crc16_table[i] = c16;
+    }
+}
+
+uint8_t e2e_crc8(const uint8_t *data, size_t len, uint8_t crc)
+{
+    while (len--)
+        crc = crc8_table[crc ^ *data++];
+    return crc;
+}
+
+uint16_t e2e_crc16(const uint8_t *data, size_t len, uint16_t crc)
+{
+    while (len--)
+        crc = (uint16_t)((crc << 8) ^ crc16_table[(crc >> 8) ^ *data++]);
+    return crc;
+}
+
+/* CRC over data ID (low byte first) and payload, skipping the CRC bytes. */
+static uint16_t compute_crc(const E2EConfig *cfg, const CAN_Message *msg)
+{
+    uint8_t id[2] = { cfg->data_id & 0xFF, cfg->data_id >> 8 };
+    int crc_len = cfg->profile == E2E_CRC16 ? 2 : 1;
+    int tail = cfg->crc_byte + crc_len;
+
+    if (cfg->profile == E2E_CRC16) {
+        uint16_t crc = e2e_crc16(id, 2, 0xFFFF);
+        crc = e2e_crc16(msg->data, cfg->crc_byte, crc);
+        if (tail < msg->dlc)
+            crc = e2e_crc16(msg->data + tail, msg->dlc - tail, crc);
+        return crc;
+    }
+
+    uint8_t crc = e2e_crc8(id, 2, 0xFF);
+    crc = e2e_crc8(msg->data, cfg->crc_byte, crc);
+    if (tail < msg->dlc)
+        crc = e2e_crc8(msg->data + tail, msg->dlc - tail, crc);
+    return (uint8_t)(crc ^ 0xFF);
+}
+
+static uint16_t received_crc(const E2EConfig *cfg, const CAN_Message *msg)
+{
+    if (cfg->profile == E2E_CRC16)
+        return (uint16_t)((msg->data[cfg->crc_byte] << 8) | msg->data[cfg->crc_byte + 1]);
+    return msg->data[cfg->crc_byte];
+}
+
+/* PUBLIC API */
+
+void e2e_register(uint16_t can_id, const char *message_name)
+{
+    if (can_id >= E2E_MAX_IDS)
+        return;
+
+    memset(&states[can_id], 0, sizeof(states[can_id]));
+    states[can_id].name       = message_name;
+    states[can_id].registered = 1;
+}
+
+int e2e_crc_ok(const E2EConfig *cfg, const CAN_Message *msg)
+{
+    return compute_crc(cfg, msg) == received_crc(cfg, msg);
+}
+
+E2EResult e2e_check(const E2EConfig *cfg, const CAN_Message *msg, int crc_ok)
+{
+    if (msg->id >= E2E_MAX_IDS)
+        return E2E_ERR_UNKNOWN_ID;
+
+    E2EState *st = &states[msg->id];
+    E2EResult result;
+
+    if (!crc_ok) {
+        result = E2E_ERR_CRC;
+    }
+    else {
+        uint8_t counter = msg->data[cfg->counter_byte] & 0x0F;
+        uint8_t delta = (uint8_t)((counter - st->last_counter) & (E2E_COUNTER_MOD - 1));
+        uint8_t max_delta = cfg->max_delta ? cfg->max_delta : 1;
+
+        if (!st->have_counter || delta == 1)
+            result = E2E_OK;
+        else if (delta == 0)
+            result = E2E_ERR_REPEATED;
+        else if (delta <= max_delta)
+            result = E2E_OK_SOME_LOST;
+        else
+            result = E2E_ERR_WRONG_SEQUENCE;
+
+        if (result != E2E_ERR_REPEATED) {
+            st->last_counter = counter;
+            st->have_counter = 1;
+        }
+    }
+
+    st->results[result]++;
+    return result;
+}
+
+void e2e_protect(const E2EConfig *cfg, CAN_Message *msg, uint8_t counter)
+{
+    if (!cfg || cfg->profile == E2E_NONE)
+        return;
+
+    msg->data[cfg->counter_byte] = (uint8_t)((msg->data[cfg->counter_byte] & 0xF0) |
+                                             (counter & 0x0F));
+
+    uint16_t crc = compute_crc(cfg, msg);
+    if (cfg->profile == E2E_CRC16) {
+        msg->data[cfg->crc_byte]     = (uint8_t)(crc >> 8);
+        msg->data[cfg->crc_byte + 1] = (uint8_t)(crc & 0xFF);
+    }
+    else {
+        msg->data[cfg->crc_byte] = (uint8_t)crc;
+    }
+}
+
+const char *e2e_result_name(E2EResult result)
+{
+    return result_names[result];
+}
+
+/* METRICS */
+
+int e2e_write_metrics(char *buf, size_t len)
+{
+    int off = snprintf(buf, len, "# TYPE can_e2e_frames_total counter\n");
+
+    for (int id = 0; id < E2E_MAX_IDS && off > 0 && (size_t)off < len; id++) {
+        const E2EState *st = &states[id];
+        if (!st->registered)
+            continue;
+
+        for (int r = 0; r < E2E_RESULT_COUNT && off > 0 && (size_t)off < len; r++) {
+            off += snprintf(buf + off, len - off,
+                            "can_e2e_frames_total{id=\"0x%03X\",message=\"%s\",result=\"%s\"} %llu\n",
+                            id, st->name, result_names[r], (unsigned long long)st->results[r]);
+        }
+    }
+
+    return (off > 0 && (size_t)off < len) ? off : (int)(len ? len - 1 : 0);
+}
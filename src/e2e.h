@@ -0,0 +1,78 @@
+#ifndef E2E_H
+#define E2E_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_message.h"
+
+/* End-to-end protection of CAN payloads, in the style of AUTOSAR E2E
+ * profiles 1/2: a CRC over a 16-bit data ID and the payload (without the
+ * CRC itself) plus a 4-bit alive counter in the low nibble of a byte.
+ *
+ *   E2E_CRC8   CRC-8/SAE-J1850 (poly 0x1D, init 0xFF, xorout 0xFF) in crc_byte
+ *   E2E_CRC16  CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) in
+ *              crc_byte (high) and crc_byte + 1 (low)
+ *
+ * The counter must advance by 1..max_delta per frame (mod 16). A larger
+ * jump re-synchronizes on the new value but rejects that frame.
+ */
+
+typedef enum
+{
+    E2E_NONE = 0,
+    E2E_CRC8,
+    E2E_CRC16
+} E2EProfile;
+
+typedef struct
+{
+    E2EProfile profile;
+    uint8_t    crc_byte;
+    uint8_t    counter_byte;
+    uint8_t    max_delta;      /* Largest accepted counter step, 0 = 1 */
+    uint16_t   data_id;
+} E2EConfig;
+
+typedef enum
+{
+    E2E_OK,
+    E2E_OK_SOME_LOST,          /* Accepted, 1..max_delta-1 frames were lost */
+    E2E_ERR_CRC,
+    E2E_ERR_REPEATED,
+    E2E_ERR_WRONG_SEQUENCE,
+    E2E_ERR_UNKNOWN_ID         /* ID beyond the state table, not checked */
+} E2EResult;
+
+#define E2E_FAILED(result) ((result) >= E2E_ERR_CRC)
+
+/* Build the CRC tables. */
+void e2e_init(void);
+
+uint8_t  e2e_crc8(const uint8_t *data, size_t len, uint8_t crc);
+uint16_t e2e_crc16(const uint8_t *data, size_t len, uint16_t crc);
+
+/* Track counters and failures of can_id under message_name. */
+void e2e_register(uint16_t can_id, const char *message_name);
+
+/* 1 if the CRC of a frame matches. Stateless, safe from any thread. */
+int e2e_crc_ok(const E2EConfig *cfg, const CAN_Message *msg);
+
+/* Count the CRC result of a frame (crc_ok from e2e_crc_ok()) and, if it
+ * passed, check its alive counter and update the counter state of its
+ * ID. Standard IDs only: others give E2E_ERR_UNKNOWN_ID. Not thread-safe
+ * per ID.
+ */
+E2EResult e2e_check(const E2EConfig *cfg, const CAN_Message *msg, int crc_ok);
+
+/* Write counter and CRC into a frame (sender side, used by the simulator). */
+void e2e_protect(const E2EConfig *cfg, CAN_Message *msg, uint8_t counter);
+
+const char *e2e_result_name(E2EResult result);
+
+/* Writes per-message check results in Prometheus text format.
+ * Returns bytes written.
+ */
+int e2e_write_metrics(char *buf, size_t len);
+
+#endif /* E2E_H */
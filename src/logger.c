@@ -14,10 +14,14 @@ void logger_init(void)
     }
 }
 
-static void format_timestamp(char *buf, size_t len)
+/* Formats the frame's own timestamp; samples may reach the log after
+ * a delay (held by compression), so "now" would be wrong. */
+static void format_timestamp(uint64_t timestamp_us, char *buf, size_t len)
 {
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
+    time_t when = (time_t)(timestamp_us / 1000000u);
+    if (when == 0)
+        when = time(NULL);
+    struct tm *t = localtime(&when);
     strftime(buf, len, "%Y-%m-%d %H:%M:%S", t);
 }
 
@@ -31,11 +35,12 @@ void log_can_message(const CAN_Message *msg,
         return;
 
     char timestamp[32];
-    format_timestamp(timestamp, sizeof(timestamp));
+    format_timestamp(msg->timestamp_us, timestamp, sizeof(timestamp));
 
-    fprintf(log_file,
-            "%s | 0x%03X | %d | ",
-            timestamp, msg->id, msg->dlc);
+    if (msg->id & CAN_EFF_FLAG)
+        fprintf(log_file, "%s | 0x%08X | %d | ", timestamp, msg->id & CAN_EFF_MASK, msg->dlc);
+    else
+        fprintf(log_file, "%s | 0x%03X | %d | ", timestamp, msg->id, msg->dlc);
 
     for (int i = 0; i < msg->dlc; i++) {
         fprintf(log_file, "%02X ", msg->data[i]);
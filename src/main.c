@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <time.h>
 
 #ifdef _WIN32
@@ -18,12 +19,30 @@
 #include "tests.h"
 #include "logger.h"
 #include "data_model.h"
+#include "platform.h"
+#include "bulk_decoder.h"
+#include "decoder_fuzz.h"
+#include "udp_publisher.h"
+#include "shm_publisher.h"
+#include "shm_reader.h"
+#include "shm_layout.h"
+#include "scenario.h"
+#include "pipeline.h"
+#include "realtime.h"
+#include "supervision.h"
+#include "e2e.h"
+#include "transport.h"
+#include "bus_analyzer.h"
+#include "console.h"
 /* CAN MESSAGE UTILITIES */
 
 /* Prints a CAN message frame. */
 void print_can_message(const CAN_Message *msg)
 {
-    printf("ID: 0x%03X | DLC: %d | Data: [", msg->id, msg->dlc);
+    if (msg->id & CAN_EFF_FLAG)
+        printf("ID: 0x%08X | DLC: %d | Data: [", msg->id & CAN_EFF_MASK, msg->dlc);
+    else
+        printf("ID: 0x%03X | DLC: %d | Data: [", msg->id, msg->dlc);
 
     for (int i = 0; i < msg->dlc; i++) {
         printf("%02X", msg->data[i]);
@@ -45,9 +64,12 @@ typedef struct
     float battery_soc;
     float battery_voltage;
     float motor_temperature;
+    float motor_torque;
 
     int rpm_direction;
     int speed_increasing;
+    uint8_t alive_counter;     /* E2E counter of protected messages */
+    int     pack_transfers;    /* J1939 transfers sent, alternates BAM and RTS/CTS */
     
 } CAN_Simulator;
 
@@ -59,6 +81,9 @@ void simulator_init(CAN_Simulator *sim)
     sim->battery_soc       = 100.0f;
     sim->battery_voltage   = 62.0f;
     sim->motor_temperature = 25.0f;
+    sim->motor_torque      = 0.0f;
+    sim->alive_counter     = 0;
+    sim->pack_transfers    = 0;
     sim->rpm_direction     = 1.0f;
     sim->speed_increasing  = 1.0f;
 }
@@ -106,6 +131,11 @@ else {
     /* Battery voltage estimation */
     sim->battery_voltage = 48.0f + (sim->battery_soc / 100.0f);
 
+    /* Drive torque while accelerating, regenerative braking otherwise */
+    sim->motor_torque = (sim->rpm_direction == 1)
+                      ? 250.0f - sim->motor_rpm / 50.0f
+                      : -80.0f;
+
     /* Motor temperature rise with RPM */
     float target_temp = 25.0f + (sim->motor_rpm / 8000.0f) * 75.0f;
     if (sim->motor_temperature < target_temp) {
@@ -121,11 +151,11 @@ CAN_Message make_rpm_message(const CAN_Simulator *sim)
     CAN_Message msg = {0};
     uint16_t rpm = (uint16_t)sim->motor_rpm;
 
-    msg.id        = 0x101;
-    msg.dlc       = 2;
-    msg.data[0]   = (rpm >> 8) & 0xFF;
-    msg.data[1]   = rpm & 0xFF;
-    msg.timestamp = time(NULL);
+    msg.id           = 0x101;
+    msg.dlc          = 2;
+    msg.data[0]      = (rpm >> 8) & 0xFF;
+    msg.data[1]      = rpm & 0xFF;
+    msg.timestamp_us = platform_wall_time_us();
 
     return msg;
 }
@@ -136,11 +166,11 @@ CAN_Message make_speed_message(const CAN_Simulator *sim)
     CAN_Message msg = {0};
     uint16_t speed = (uint16_t)(sim->vehicle_speed * 10);
 
-    msg.id        = 0x102;
-    msg.dlc       = 2;
-    msg.data[0]   = (speed >> 8) & 0xFF;
-    msg.data[1]   = speed & 0xFF;
-    msg.timestamp = time(NULL);
+    msg.id           = 0x102;
+    msg.dlc          = 2;
+    msg.data[0]      = (speed >> 8) & 0xFF;
+    msg.data[1]      = speed & 0xFF;
+    msg.timestamp_us = platform_wall_time_us();
 
     return msg;
 }
@@ -150,10 +180,10 @@ CAN_Message make_soc_message(const CAN_Simulator *sim)
 {
     CAN_Message msg = {0};
 
-    msg.id        = 0x103;
-    msg.dlc       = 1;
-    msg.data[0]   = (uint8_t)sim->battery_soc;
-    msg.timestamp = time(NULL);
+    msg.id           = 0x103;
+    msg.dlc          = 1;
+    msg.data[0]      = (uint8_t)sim->battery_soc;
+    msg.timestamp_us = platform_wall_time_us();
 
     return msg;
 }
@@ -164,11 +194,11 @@ CAN_Message make_voltage_message(const CAN_Simulator *sim)
     CAN_Message msg = {0};
     uint16_t voltage = (uint16_t)(sim->battery_voltage * 10);
 
-    msg.id        = 0x104;
-    msg.dlc       = 2;
-    msg.data[0]   = (voltage >> 8) & 0xFF;
-    msg.data[1]   = voltage & 0xFF;
-    msg.timestamp = time(NULL);
+    msg.id           = 0x104;
+    msg.dlc          = 2;
+    msg.data[0]      = (voltage >> 8) & 0xFF;
+    msg.data[1]      = voltage & 0xFF;
+    msg.timestamp_us = platform_wall_time_us();
 
     return msg;
 }
@@ -178,19 +208,110 @@ CAN_Message make_temp_message(const CAN_Simulator *sim)
 {
     CAN_Message msg = {0};
 
-    msg.id        = 0x105;
-    msg.dlc       = 1;
-    msg.data[0]   = (uint8_t)sim->motor_temperature;
-    msg.timestamp = time(NULL);
+    msg.id           = 0x105;
+    msg.dlc          = 1;
+    msg.data[0]      = (uint8_t)sim->motor_temperature;
+    msg.timestamp_us = platform_wall_time_us();
+
+    return msg;
+}
+
+/* 0x110 – Inverter status: torque (×10, +1000 Nm offset), E2E protected */
+CAN_Message make_torque_message(CAN_Simulator *sim)
+{
+    CAN_Message msg = {0};
+    uint16_t torque = (uint16_t)((sim->motor_torque + 1000.0f) * 10);
+
+    msg.id           = 0x110;
+    msg.dlc          = 4;
+    msg.data[0]      = (torque >> 8) & 0xFF;
+    msg.data[1]      = torque & 0xFF;
+    msg.timestamp_us = platform_wall_time_us();
+
+    e2e_protect(parser_e2e_config(msg.id), &msg, sim->alive_counter++);
 
     return msg;
 }
 
+/* MULTI-FRAME MESSAGES */
+
+#define SIM_MAX_FRAMES 8       /* Frames of the longest simulated transfer */
+
+/* 0x7E8 – BMS response to UDS ReadDataByIdentifier 0xF101: four cell
+ * voltages in mV, sent over ISO-TP. Returns the number of frames.
+ */
+int make_cell_voltage_frames(const CAN_Simulator *sim, CAN_Message *frames)
+{
+    uint8_t payload[11] = { 0x62, 0xF1, 0x01 };
+
+    for (int cell = 0; cell < 4; cell++) {
+        uint16_t mv = (uint16_t)(3000.0f + sim->battery_soc * 12.0f - cell * 7);
+        payload[3 + cell * 2] = (mv >> 8) & 0xFF;
+        payload[4 + cell * 2] = mv & 0xFF;
+    }
+
+    int count = transport_segment_isotp(0x7E8, payload, sizeof(payload), frames, SIM_MAX_FRAMES);
+    for (int i = 0; i < count; i++)
+        frames[i].timestamp_us = platform_wall_time_us();
+    return count;
+}
+
+/* PGN 0xFF10 from SA 0xF3 – pack current (×10, +1000 A offset) and
+ * insulation resistance, sent over J1939 TP, alternately broadcast (BAM)
+ * and to the VCU at 0x27 (RTS/CTS). Returns the number of frames.
+ */
+int make_pack_status_frames(CAN_Simulator *sim, CAN_Message *frames)
+{
+    uint8_t payload[12];
+    uint16_t current = (uint16_t)((sim->motor_torque * 0.8f + 1000.0f) * 10);
+    uint16_t insulation = (uint16_t)(1500 + (int)sim->motor_temperature);
+
+    memset(payload, 0xFF, sizeof(payload));
+    payload[0] = (current >> 8) & 0xFF;
+    payload[1] = current & 0xFF;
+    payload[2] = (insulation >> 8) & 0xFF;
+    payload[3] = insulation & 0xFF;
+
+    uint8_t dest = (sim->pack_transfers++ % 2) ? 0x27 : J1939_ADDR_GLOBAL;
+    int count = transport_segment_j1939(0xFF10, 6, 0xF3, dest, payload, sizeof(payload),
+                                        frames, SIM_MAX_FRAMES);
+    for (int i = 0; i < count; i++)
+        frames[i].timestamp_us = platform_wall_time_us();
+    return count;
+}
+
 /* SIMULATION LOOP */
 
+/* Sends one frame, through the fault-injection scenario if one is loaded. */
+static void transmit_frame(const CAN_Message *msg)
+{
+    if (!scenario_active()) {
+        pipeline_ingest(msg);
+        return;
+    }
+
+    /* Fault injection: the scenario decides what reaches the decoder and when. */
+    CAN_Message frames[SCENARIO_MAX_OUT];
+    int n = scenario_apply(msg, frames);
+    for (int j = 0; j < n; j++)
+        pipeline_ingest(&frames[j]);
+
+    uint64_t delay = scenario_delay_us();
+    if (delay >= 1000)
+        SLEEP_MS(delay / 1000);
+}
+
+/* Sends the frames of one message back to back. */
+static void transmit_frames(const CAN_Message *frames, int count)
+{
+    for (int i = 0; i < count; i++)
+        transmit_frame(&frames[i]);
+}
+
 void run_simulation(void)
 {
     CAN_Simulator simulator;
+    CAN_Message transfer[SIM_MAX_FRAMES];
     simulator_init(&simulator);
 
     while (1) {
@@ -201,17 +322,68 @@ void run_simulation(void)
             make_speed_message(&simulator),
             make_soc_message(&simulator),
             make_voltage_message(&simulator),
-            make_temp_message(&simulator)
+            make_temp_message(&simulator),
+            make_torque_message(&simulator)
         };
 
-        for (int i = 0; i < 5; i++) {
-            print_can_message(&messages[i]);
-            parse_can_message(&messages[i]);
-            SLEEP_MS(100);
+        /* The multi-frame messages share the first slot, so every
+         * message keeps its 600 ms cycle.
+         */
+        transmit_frames(transfer, make_cell_voltage_frames(&simulator, transfer));
+        transmit_frames(transfer, make_pack_status_frames(&simulator, transfer));
+
+        for (int i = 0; i < (int)(sizeof(messages) / sizeof(messages[0])); i++) {
+            transmit_frames(&messages[i], 1);
+            if (!scenario_active())
+                SLEEP_MS(100);
         }
     }
 }
 
+/* SHARED MEMORY READER (test tool) */
+
+#define SHM_READ_ROUNDS 1000
+
+/* Prints a consistent snapshot of the shared-memory state once per
+ * second, with the cost of taking it.
+ */
+static int run_shm_reader(const char *name)
+{
+    ShmReader *reader = shm_reader_open(name);
+    if (!reader) {
+        printf("ERROR: No compatible shared memory segment at %s\n", name);
+        return 1;
+    }
+
+    int count = shm_reader_count(reader);
+    ShmSample samples[MAX_SIGNALS];
+    if (count > MAX_SIGNALS)
+        count = MAX_SIGNALS;
+
+    while (1) {
+        uint64_t start = platform_time_us();
+        for (int round = 0; round < SHM_READ_ROUNDS; round++) {
+            for (int i = 0; i < count; i++)
+                shm_reader_read(reader, i, &samples[i]);
+        }
+        uint64_t elapsed = platform_time_us() - start;
+
+        printf("--- %d signal(s), %.1f ns per snapshot ---\n", count, elapsed * 1000.0 / SHM_READ_ROUNDS);
+        for (int i = 0; i < count; i++) {
+            printf("  %-18s %10.2f %-4s %-7s v%lu\n",
+                   shm_reader_name(reader, i), samples[i].value,
+                   shm_reader_unit(reader, i),
+                   (samples[i].flags & SIGNAL_FLAG_WARNING) ? "WARNING" : "OK",
+                   (unsigned long)samples[i].version);
+        }
+        fflush(stdout);
+        SLEEP_MS(1000);
+    }
+
+    shm_reader_close(reader);
+    return 0;
+}
+
 /* WEB SERVER THREAD */
 
 #ifdef _WIN32
@@ -230,10 +402,199 @@ void *web_server_thread(void *arg)
 }
 #endif
 
+/* COMMAND LINE */
+
+static void print_usage(const char *prog)
+{
+    printf("Usage:\n");
+    printf("  %s                      Interactive mode (menu)\n", prog);
+    printf("  %s --decode <trace> [-o <out.csv>] [-j <threads>]\n", prog);
+    printf("                          Decode a recorded trace to CSV and exit\n");
+    printf("  %s --fuzz-decoder <cases> [-j <threads>] [--seed <n>]\n", prog);
+    printf("                          Check the signal decoder against a bit-by-bit reference\n");
+    printf("                          on random layouts and payloads, report throughput and exit\n");
+    printf("  %s --udp-listen <addr:port>\n", prog);
+    printf("                          Print datagrams of a UDP publisher and exit on Ctrl+C\n");
+    printf("  %s --shm-read <name>\n", prog);
+    printf("                          Print the shared-memory state of a running instance\n");
+    printf("\nInteractive mode options:\n");
+    printf("  --udp <addr:port>       Publish decoded samples over UDP (multicast or unicast)\n");
+    printf("  --udp-batch <n>         Samples per datagram (default %d, max %d)\n",
+           UDP_DEFAULT_BATCH, UDP_MAX_ENTRIES);
+    printf("  --scenario <file>       Inject bursts and faults into simulation mode (see src/scenario.h)\n");
+    printf("  --seed <n>              Seed for --scenario, to replay a run (default: time based)\n");
+    printf("  --bitrate <bit/s>       Bus bit rate for the load analysis (default %d)\n",
+           BUS_DEFAULT_BITRATE);
+    printf("  --console <mode>        Simulation output: table (refreshed view) or verbose\n");
+    printf("                          (sampled frames and messages), default table\n");
+    printf("  --console-hz <n>        Console refresh rate (default %d)\n", CONSOLE_DEFAULT_HZ);
+    printf("  --sample <n>            Verbose console: print one frame in n (default %d)\n",
+           CONSOLE_DEFAULT_SAMPLE);
+    printf("  --queue <q>=<policy>[:<n>]\n");
+    printf("                          Queue policy and capacity for q = ingest|sink, policy =\n");
+    printf("                          block|drop-oldest|drop-newest|latest (default ingest=latest:%d,\n",
+           PIPELINE_INGEST_DEFAULT_CAPACITY);
+    printf("                          sink=drop-oldest:%d)\n", PIPELINE_SINK_DEFAULT_CAPACITY);
+    printf("  --rt                    Latency-deterministic mode: lock memory, pin threads\n");
+    printf("  --rt-cpus <i>,<d>       CPUs for the ingest and decode threads (with --rt)\n");
+    printf("  --rt-fifo <prio>        Run ingest and decode threads with SCHED_FIFO (with --rt)\n");
+    printf("  --shm <name>            Publish live state in shared memory (e.g. %s)\n",
+           SHM_DEFAULT_NAME);
+}
+
 /* MAIN APPLICATION */
-int main(void)
+int main(int argc, char **argv)
 {
     int choice = 0;
+    BulkDecodeOptions bulk = {0};
+    uint64_t fuzz_cases = 0;
+    const char *udp_target = NULL;
+    const char *udp_listen = NULL;
+    int udp_batch = 0;
+    const char *shm_name = NULL;
+    const char *shm_read = NULL;
+    const char *scenario_path = NULL;
+    uint32_t seed = (uint32_t)platform_wall_time_us();
+    uint32_t bitrate = BUS_DEFAULT_BITRATE;
+    PipelineConfig pipeline;
+    pipeline_default_config(&pipeline);
+    RealtimeConfig rt;
+    realtime_default_config(&rt);
+    ConsoleConfig console;
+    console_default_config(&console);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--decode") == 0 && i + 1 < argc) {
+            bulk.input_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--fuzz-decoder") == 0 && i + 1 < argc) {
+            fuzz_cases = strtoull(argv[++i], NULL, 0);
+            if (fuzz_cases == 0) {
+                printf("ERROR: Expected a number of cases, got %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            bulk.output_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            bulk.threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--udp") == 0 && i + 1 < argc) {
+            udp_target = argv[++i];
+        }
+        else if (strcmp(argv[i], "--udp-batch") == 0 && i + 1 < argc) {
+            udp_batch = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--udp-listen") == 0 && i + 1 < argc) {
+            udp_listen = argv[++i];
+        }
+        else if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+            shm_name = argv[++i];
+        }
+        else if (strcmp(argv[i], "--shm-read") == 0 && i + 1 < argc) {
+            shm_read = argv[++i];
+        }
+        else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+            scenario_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--bitrate") == 0 && i + 1 < argc) {
+            bitrate = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (bitrate == 0) {
+                printf("ERROR: Expected a bit rate in bit/s, got %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--console") == 0 && i + 1 < argc) {
+            if (console_parse_mode(argv[++i], &console.mode) < 0) {
+                printf("ERROR: Expected table or verbose, got %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--console-hz") == 0 && i + 1 < argc) {
+            console.refresh_hz = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--sample") == 0 && i + 1 < argc) {
+            console.sample_every = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--rt") == 0) {
+            rt.enabled = 1;
+        }
+        else if (strcmp(argv[i], "--rt-cpus") == 0 && i + 1 < argc) {
+            if (realtime_parse_cpus(&rt, argv[++i]) < 0) {
+                printf("ERROR: Expected <ingest_cpu>,<decode_cpu>, got %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--rt-fifo") == 0 && i + 1 < argc) {
+            rt.fifo_priority = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+            if (pipeline_parse_queue_option(&pipeline, argv[++i]) < 0) {
+                printf("ERROR: Expected <ingest|sink>=<policy>[:<capacity>], got %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (parser_init() < 0)
+        return 1;
+    bus_analyzer_init(bitrate);
+
+    /* Batch mode: no logger, web server or menu */
+    if (bulk.input_path) {
+        return bulk_decode(&bulk) == 0 ? 0 : 1;
+    }
+
+    if (fuzz_cases) {
+        DecoderFuzzOptions fuzz = { fuzz_cases, bulk.threads, seed };
+        DecoderFuzzResult result;
+        printf("Seed %lu\n", (unsigned long)seed);
+        int rc = decoder_fuzz_run(&fuzz, &result);
+        decoder_fuzz_print(&result);
+        return rc == 0 ? 0 : 1;
+    }
+
+    /* UDP receiver test tool */
+    if (udp_listen) {
+        char addr[64];
+        uint16_t port;
+        if (udp_parse_endpoint(udp_listen, addr, sizeof(addr), &port) < 0) {
+            printf("ERROR: Expected <addr:port>, got %s\n", udp_listen);
+            return 1;
+        }
+        return udp_receiver_run(addr, port);
+    }
+
+    if (shm_read) {
+        return run_shm_reader(shm_read);
+    }
+
+    if (udp_target) {
+        char addr[64];
+        uint16_t port;
+        if (udp_parse_endpoint(udp_target, addr, sizeof(addr), &port) < 0 ||
+            udp_publisher_init(addr, port, udp_batch) < 0) {
+            printf("ERROR: Cannot publish to %s\n", udp_target);
+            return 1;
+        }
+    }
+
+    if (scenario_path && scenario_load(scenario_path, seed) < 0) {
+        return 1;
+    }
+
+    if (shm_name && shm_publisher_init(shm_name) < 0) {
+        return 1;
+    }
+
     logger_init();
     #ifdef _WIN32
         CreateThread(NULL, 0, web_server_thread, NULL, 0, NULL);
@@ -263,6 +624,11 @@ int main(void)
     else if (choice == MODE_SIMULATION) {
         printf("\n--- Running SIMULATION MODE ---\n");
         g_vehicle_data.mode = MODE_SIMULATION;
+        realtime_init(&rt);
+        if (pipeline_start(&pipeline) < 0 || supervision_start() < 0 ||
+            console_start(&console) < 0)
+            return 1;
+        realtime_enter_thread(RT_THREAD_INGEST);
         run_simulation();  
     }
     else {
@@ -5,128 +5,433 @@
 #include "parser.h"
 #include "data_model.h"
 #include "can_message.h"
-#include "logger.h"
+#include "compression.h"
+#include "platform.h"
+#include "signal_registry.h"
+#include "pipeline.h"
+#include "shm_publisher.h"
+#include "supervision.h"
+#include "e2e.h"
+#include "transport.h"
+#include "signal_stats.h"
+#include "console.h"
 
 /* DBC-LIKE SIGNAL DEFINITION */
 
+/* How a message reaches the decoder. */
+typedef enum
+{
+    MSG_CAN,                   /* Single standard frame */
+    MSG_ISOTP,                 /* ISO-TP payload on a standard ID */
+    MSG_J1939                  /* J1939 parameter group, single frame or TP */
+} MessageType;
+
 /* Describes a CAN signal using DBC-style. */
 typedef struct
 {
     /* Message-level metadata (BO_) */
-    uint16_t    can_id;
+    uint32_t    can_id;        /* Standard ID, or PGN for MSG_J1939 */
     const char *message_name;
-    uint8_t     dlc;
+    uint16_t    cycle_ms;      /* GenMsgCycleTime, 0 = not cyclic */
+    MessageType type;
 
     /* Signal-level metadata (SG_) */
     const char *signal_name;
-    uint8_t     start_bit;
-    uint8_t     bit_length;
 
-    /* Conversion parameters */
-    float scale;
-    float offset;
-
-    /* Validation limits */
-    float min;
-    float max;
+    /* Bit layout, message DLC (beyond 8 for transport messages),
+     * conversion and validation limits, as decode_signal() takes them
+     */
+    SignalDef def;
 
     /* Display unit */
     const char *unit;
+
+    /* Sample compression towards the sinks */
+    CompressConfig compress;
+
+    /* End-to-end protection of the message (read from its first row) */
+    E2EConfig e2e;
+
+    /* Registry handle, assigned by parser_init() */
+    SignalHandle handle;
 } CAN_SignalDef;
 
 /* SIGNAL TABLE (Lookup Table) */
 
 static CAN_SignalDef signal_table[] =
 {
-    { 0x101, "MotorRPM",       2, "Motor_RPM",        0, 16, 1.0f, 0.0f,   0.0f, 10000.0f, "rpm"  },
-    { 0x102, "VehicleSpeed",   2, "Vehicle_Speed",    0, 16, 0.1f, 0.0f,   0.0f,   120.0f, "km/h" },
-    { 0x103, "BatterySOC",     1, "Battery_SOC",      0,  8, 1.0f, 0.0f,   0.0f,   100.0f, "%"    },
-    { 0x104, "BatteryVoltage", 2, "Battery_Voltage",  0, 16, 0.1f, 0.0f,   0.0f,   100.0f, "V"    },
-    { 0x105, "MotorTemp",      1, "Motor_Temperature",0,  8, 1.0f, 0.0f,   0.0f,   150.0f, "C"    }
+    { 0x101, "MotorRPM",       600, MSG_CAN, "Motor_RPM",         { { 0, 16, SIGNAL_BIG_ENDIAN, 0 }, 2, 1.0f,     0.0f,    0.0f, 10000.0f }, "rpm",  { COMPRESS_DEADBAND_ABS,     50.0f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+    { 0x102, "VehicleSpeed",   600, MSG_CAN, "Vehicle_Speed",     { { 0, 16, SIGNAL_BIG_ENDIAN, 0 }, 2, 0.1f,     0.0f,    0.0f,   120.0f }, "km/h", { COMPRESS_SWINGING_DOOR,     0.5f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+    { 0x103, "BatterySOC",     600, MSG_CAN, "Battery_SOC",       { { 0,  8, SIGNAL_BIG_ENDIAN, 0 }, 1, 1.0f,     0.0f,    0.0f,   100.0f }, "%",    { COMPRESS_DEADBAND_ABS,      0.0f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+    { 0x104, "BatteryVoltage", 600, MSG_CAN, "Battery_Voltage",   { { 0, 16, SIGNAL_BIG_ENDIAN, 0 }, 2, 0.1f,     0.0f,    0.0f,   100.0f }, "V",    { COMPRESS_DEADBAND_PERCENT,  0.5f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+    { 0x105, "MotorTemp",      600, MSG_CAN, "Motor_Temperature", { { 0,  8, SIGNAL_BIG_ENDIAN, 0 }, 1, 1.0f,     0.0f,    0.0f,   150.0f }, "C",    { COMPRESS_SWINGING_DOOR,     0.5f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+    { 0x110, "InverterStatus", 600, MSG_CAN, "Motor_Torque",      { { 0, 16, SIGNAL_BIG_ENDIAN, 0 }, 4, 0.1f, -1000.0f, -300.0f,   300.0f }, "Nm",   { COMPRESS_DEADBAND_ABS,      1.0f, 10000 },
+      { E2E_CRC8, 3, 2, 2, 0x0110 }, SIGNAL_INVALID },
+
+    /* UDS ReadDataByIdentifier 0xF101 response of the BMS (ISO-TP) */
+    { 0x7E8, "BMSCellVoltages", 0, MSG_ISOTP, "Cell1_Voltage", { { 24, 16, SIGNAL_BIG_ENDIAN, 0 }, 11, 0.001f, 0.0f, 2.5f, 4.25f }, "V", { COMPRESS_DEADBAND_ABS, 0.005f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+    { 0x7E8, "BMSCellVoltages", 0, MSG_ISOTP, "Cell2_Voltage", { { 40, 16, SIGNAL_BIG_ENDIAN, 0 }, 11, 0.001f, 0.0f, 2.5f, 4.25f }, "V", { COMPRESS_DEADBAND_ABS, 0.005f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+    { 0x7E8, "BMSCellVoltages", 0, MSG_ISOTP, "Cell3_Voltage", { { 56, 16, SIGNAL_BIG_ENDIAN, 0 }, 11, 0.001f, 0.0f, 2.5f, 4.25f }, "V", { COMPRESS_DEADBAND_ABS, 0.005f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+    { 0x7E8, "BMSCellVoltages", 0, MSG_ISOTP, "Cell4_Voltage", { { 72, 16, SIGNAL_BIG_ENDIAN, 0 }, 11, 0.001f, 0.0f, 2.5f, 4.25f }, "V", { COMPRESS_DEADBAND_ABS, 0.005f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+
+    /* Proprietary PGN 0xFF10 from the battery pack (J1939 TP, 12 bytes) */
+    { 0xFF10, "PackStatus", 0, MSG_J1939, "Pack_Current",          { {  0, 16, SIGNAL_BIG_ENDIAN, 0 }, 12, 0.1f, -1000.0f, -500.0f,  500.0f }, "A",    { COMPRESS_DEADBAND_ABS,     1.0f, 10000 }, { E2E_NONE }, SIGNAL_INVALID },
+    { 0xFF10, "PackStatus", 0, MSG_J1939, "Insulation_Resistance", { { 16, 16, SIGNAL_BIG_ENDIAN, 0 }, 12, 1.0f,     0.0f,    0.0f, 5000.0f }, "kOhm", { COMPRESS_DEADBAND_PERCENT, 1.0f, 10000 }, { E2E_NONE }, SIGNAL_INVALID }
 };
 
 #define SIGNAL_COUNT (sizeof(signal_table) / sizeof(signal_table[0]))
 
+/* CAN ID INDEX
+ * first_signal[id] is the first table row for a standard ID, next_signal[]
+ * chains further rows of the same message; -1 terminates. J1939 messages
+ * are found by PGN in a small open-addressing table instead.
+ */
+
+#define CAN_STD_ID_COUNT 0x800
+#define PGN_INDEX_SIZE   32     /* Power of two, above the number of PGNs */
+
+static int16_t  first_signal[CAN_STD_ID_COUNT];
+static int16_t  next_signal[SIGNAL_COUNT];
+static uint32_t pgn_keys[PGN_INDEX_SIZE];
+static int16_t  pgn_first[PGN_INDEX_SIZE];
+
+static int first_signal_for(uint32_t id)
+{
+    return (id < CAN_STD_ID_COUNT) ? first_signal[id] : -1;
+}
+
+static int pgn_slot(uint32_t pgn)
+{
+    int slot = (int)((pgn * 2654435761u) >> 27) & (PGN_INDEX_SIZE - 1);
+
+    while (pgn_first[slot] >= 0 && pgn_keys[slot] != pgn)
+        slot = (slot + 1) & (PGN_INDEX_SIZE - 1);
+    return slot;
+}
+
+static int first_signal_for_pgn(uint32_t pgn)
+{
+    return pgn_first[pgn_slot(pgn)];
+}
+
+/* First table row of the message a frame belongs to. */
+static int first_signal_for_frame(const CAN_Message *msg)
+{
+    if (msg->id & CAN_EFF_FLAG)
+        return first_signal_for_pgn(j1939_pgn(msg->id));
+    return first_signal_for(msg->id);
+}
+
 /* RAW VALUE EXTRACTION */
 
-static uint32_t extract_raw_value(const CAN_Message *msg, const CAN_SignalDef *sig)
+/* Loads the bytes the signal spans into one word, then shifts and masks
+ * the signal out of it: at most 5 byte loads instead of a loop per bit.
+ */
+int64_t signal_extract_raw(const uint8_t *data, const SignalLayout *layout)
 {
-    uint32_t raw = 0;
-    int start_byte = sig->start_bit / 8;
-    int byte_len   = sig->bit_length / 8;
+    int len   = layout->bit_length;
+    int first = layout->start_bit / 8;
+    int last  = (layout->start_bit + len - 1) / 8;
+    uint64_t word = 0;
+    int shift;
 
-    for (int i = 0; i < byte_len; i++) {
-        raw = (raw << 8) | msg->data[start_byte + i];
+    if (layout->byte_order == SIGNAL_LITTLE_ENDIAN) {
+        for (int i = last; i >= first; i--)
+            word = (word << 8) | data[i];
+        shift = layout->start_bit % 8;
+    }
+    else {
+        for (int i = first; i <= last; i++)
+            word = (word << 8) | data[i];
+        shift = (last + 1) * 8 - (layout->start_bit + len);
     }
 
-    return raw;
+    uint64_t raw = (word >> shift) & ((1ull << len) - 1);
+
+    if (layout->is_signed && (raw >> (len - 1)))
+        return (int64_t)raw - ((int64_t)1 << len);
+    return (int64_t)raw;
 }
 
-/* PARSER ENTRY POINT */
+/* SUPERVISION */
 
-void parse_can_message(const CAN_Message *msg)
+/* Mirrors the staleness of a message into the flags of its signals. */
+static void on_supervision_change(uint16_t can_id, int stale)
 {
-    for (int i = 0; i < SIGNAL_COUNT; i++) {
+    for (int i = first_signal_for(can_id); i >= 0; i = next_signal[i]) {
+        SignalHandle h = signal_table[i].handle;
+        uint8_t flags;
 
-        const CAN_SignalDef *signal = &signal_table[i];
+        if (stale)
+            flags = atomic_fetch_or_explicit(&g_vehicle_data.flags[h], SIGNAL_FLAG_STALE,
+                                             memory_order_relaxed) | SIGNAL_FLAG_STALE;
+        else
+            flags = atomic_fetch_and_explicit(&g_vehicle_data.flags[h], (uint8_t)~SIGNAL_FLAG_STALE,
+                                              memory_order_relaxed) & (uint8_t)~SIGNAL_FLAG_STALE;
+
+        shm_publisher_update_flags(h, flags);
+    }
+}
+
+/* INITIALIZATION */
+
+int parser_init(void)
+{
+    for (int id = 0; id < CAN_STD_ID_COUNT; id++)
+        first_signal[id] = -1;
+    for (int slot = 0; slot < PGN_INDEX_SIZE; slot++)
+        pgn_first[slot] = -1;
+
+    transport_init();
 
-        if (signal->can_id != msg->id)
+    /* Walk backwards so each chain keeps table order. */
+    for (int i = (int)SIGNAL_COUNT - 1; i >= 0; i--) {
+        CAN_SignalDef *signal = &signal_table[i];
+
+        if (signal->type == MSG_J1939) {
+            int slot = pgn_slot(signal->can_id);
+            next_signal[i]  = pgn_first[slot];
+            pgn_keys[slot]  = signal->can_id;
+            pgn_first[slot] = (int16_t)i;
             continue;
+        }
 
-        /* Validate DLC */
-        if (msg->dlc != signal->dlc) {
-            printf("ERROR: DLC mismatch for %s (expected %d, got %d)\n",
-                   signal->message_name, signal->dlc, msg->dlc);
-            return;
+        next_signal[i] = first_signal[signal->can_id];
+        first_signal[signal->can_id] = (int16_t)i;
+
+        if (signal->type == MSG_ISOTP)
+            transport_register_isotp(signal->can_id);
+    }
+
+    for (int i = 0; i < (int)SIGNAL_COUNT; i++) {
+        CAN_SignalDef *signal = &signal_table[i];
+
+        signal->handle = signal_register(signal->signal_name, signal->unit,
+                                         signal->def.min, signal->def.max);
+        if (signal->handle == SIGNAL_INVALID)
+            return -1;
+        compression_configure(signal->handle, signal->signal_name, &signal->compress,
+                              signal->def.max - signal->def.min);
+    }
+
+    signal_stats_init();
+
+    /* One deadline and E2E state per message, taken from its first row. */
+    supervision_init(on_supervision_change);
+    e2e_init();
+    for (int id = 0; id < CAN_STD_ID_COUNT; id++) {
+        if (first_signal[id] >= 0) {
+            const CAN_SignalDef *signal = &signal_table[first_signal[id]];
+            supervision_add((uint16_t)id, signal->message_name, signal->cycle_ms);
+            if (signal->e2e.profile != E2E_NONE)
+                e2e_register((uint16_t)id, signal->message_name);
         }
+    }
+
+    return 0;
+}
+
+const E2EConfig *parser_e2e_config(uint16_t id)
+{
+    int i = first_signal_for(id);
+    if (i < 0 || signal_table[i].e2e.profile == E2E_NONE)
+        return NULL;
+    return &signal_table[i].e2e;
+}
+
+/* SINKS */
+
+/* Passes a decoded sample through its compression stage to the sinks. */
+static void publish_sample(const CAN_Message *msg, const DecodedSignal *d)
+{
+    CompressSample in = { *msg, d->value, d->out_of_range, platform_time_us() };
+    CompressSample out[COMPRESS_MAX_OUT];
+
+    int n = compression_filter(d->handle, &in, out);
+
+    for (int i = 0; i < n; i++) {
+        SinkRecord rec = { out[i], d->handle, d->name, d->unit };
+        pipeline_sink(&rec);
+    }
+}
+
+/* DECODER (no side effects, safe to call from any thread) */
 
-        /* Decode */
-        uint32_t raw = extract_raw_value(msg, signal);
-        float physical = raw * signal->scale + signal->offset;
+int decode_signal(const SignalDef *def, const uint8_t *data, uint16_t len, DecodedSignal *out)
+{
+    /* Validate DLC */
+    if (len != def->dlc)
+        return DECODE_DLC_MISMATCH;
+
+    /* Decode */
+    int64_t raw = signal_extract_raw(data, &def->layout);
+    float physical = (float)raw * def->scale + def->offset;
+
+    out->raw          = raw;
+    out->value        = physical;
+    /* Range validation */
+    out->out_of_range = (physical < def->min || physical > def->max);
+    return 0;
+}
+
+/* Decodes the signals of the message starting at table row first from
+ * a payload of len bytes.
+ */
+static int decode_payload(int first, const uint8_t *data, uint16_t len,
+                          DecodedSignal *out, int max)
+{
+    int count = 0;
+    int i = first;
+
+    if (i < 0)
+        return DECODE_UNKNOWN_ID;
+
+    for (; i >= 0 && count < max; i = next_signal[i]) {
+
+        const CAN_SignalDef *signal = &signal_table[i];
+
+        DecodedSignal *d = &out[count];
+        if (decode_signal(&signal->def, data, len, d) < 0)
+            return DECODE_DLC_MISMATCH;
+
+        d->handle = signal->handle;
+        d->name   = signal->signal_name;
+        d->unit   = signal->unit;
+        count++;
+    }
+
+    return count;
+}
 
-        /* Range validation */
-        int out_of_range = (physical < signal->min || physical > signal->max);
+int decode_can_message(const CAN_Message *msg, DecodedSignal *out, int max)
+{
+    int first = first_signal_for_frame(msg);
+    int count = decode_payload(first, msg->data, msg->dlc, out, max);
+
+    if (count >= 0 && signal_table[first].e2e.profile != E2E_NONE &&
+        !e2e_crc_ok(&signal_table[first].e2e, msg))
+        return DECODE_E2E_CRC;
+    return count;
+}
+
+/* PARSER ENTRY POINT */
 
-        if (out_of_range) {
-            printf("WARNING: %s out of range (%.2f %s)\n",
-                   signal->signal_name, physical, signal->unit);
+/* Reports why a message could not be decoded. */
+static void report_decode_error(int count, int first, uint32_t id, uint16_t len)
+{
+    if (count == DECODE_UNKNOWN_ID) {
+        if (id & CAN_EFF_FLAG)
+            console_event(CONSOLE_EVENT_UNKNOWN_ID, "INFO: Unknown CAN ID 0x%08X ignored", id & CAN_EFF_MASK);
+        else
+            console_event(CONSOLE_EVENT_UNKNOWN_ID, "INFO: Unknown CAN ID 0x%03X ignored", id);
+    }
+    else {
+        console_event(CONSOLE_EVENT_DLC, "ERROR: DLC mismatch for %s (expected %d, got %d)",
+                      signal_table[first].message_name, signal_table[first].def.dlc, len);
+    }
+}
+
+/* Hands decoded signals to the sinks and the live vehicle state. */
+static void apply_decoded(const CAN_Message *msg, const DecodedSignal *decoded, int count)
+{
+    for (int i = 0; i < count; i++) {
+
+        const DecodedSignal *d = &decoded[i];
+
+        if (d->out_of_range) {
+            console_event(CONSOLE_EVENT_RANGE, "WARNING: %s out of range (%.2f %s)",
+                          d->name, d->value, d->unit);
         }
 
-        printf("Decoded | %s = %.2f %s\n",
-               signal->signal_name, physical, signal->unit);
-        
-        log_can_message(msg,
-                signal->signal_name,
-                physical,
-                signal->unit,
-                out_of_range);
+        console_signal(d->handle, d->value, d->out_of_range);
 
+        publish_sample(msg, d);
+        signal_stats_update(d->handle, d->value);
 
         /* Update shared vehicle data */
-        if (strcmp(signal->signal_name, "Motor_RPM") == 0) {
-            g_vehicle_data.motor_rpm  = physical;
-            g_vehicle_data.rpm_warning = out_of_range;
-        }
-        else if (strcmp(signal->signal_name, "Vehicle_Speed") == 0) {
-            g_vehicle_data.vehicle_speed = physical;
-            g_vehicle_data.speed_warning = out_of_range;
-        }
-        else if (strcmp(signal->signal_name, "Battery_SOC") == 0) {
-            g_vehicle_data.battery_soc = physical;
-            g_vehicle_data.soc_warning = out_of_range;
-        }
-        else if (strcmp(signal->signal_name, "Battery_Voltage") == 0) {
-            g_vehicle_data.battery_voltage = physical;
-            g_vehicle_data.voltage_warning = out_of_range;
-        }
-        else if (strcmp(signal->signal_name, "Motor_Temperature") == 0) {
-            g_vehicle_data.motor_temperature = physical;
-            g_vehicle_data.temp_warning = out_of_range;
-        }
+        g_vehicle_data.values[d->handle] = d->value;
+        uint8_t flags;
+        if (d->out_of_range)
+            flags = atomic_fetch_or_explicit(&g_vehicle_data.flags[d->handle], SIGNAL_FLAG_WARNING,
+                                             memory_order_relaxed) | SIGNAL_FLAG_WARNING;
+        else
+            flags = atomic_fetch_and_explicit(&g_vehicle_data.flags[d->handle], (uint8_t)~SIGNAL_FLAG_WARNING,
+                                              memory_order_relaxed) & (uint8_t)~SIGNAL_FLAG_WARNING;
+
+        shm_publisher_update(d->handle, d->value, flags, msg->timestamp_us);
+    }
+}
+
+/* Decodes a payload reassembled by the transport layer. The sinks get a
+ * frame carrying its first 8 bytes.
+ */
+static void parse_transport_payload(const TransportPayload *payload)
+{
+    DecodedSignal decoded[DECODE_MAX_SIGNALS];
+    CAN_Message frame = {0};
+    int first;
+
+    if (payload->protocol == TRANSPORT_J1939) {
+        first    = first_signal_for_pgn(payload->id);
+        frame.id = j1939_id(payload->priority, payload->id, J1939_ADDR_GLOBAL, payload->source);
+    }
+    else {
+        first    = first_signal_for(payload->id);
+        frame.id = payload->id;
+    }
+
+    frame.dlc          = (uint8_t)(payload->len < 8 ? payload->len : 8);
+    frame.timestamp_us = payload->timestamp_us;
+    memcpy(frame.data, payload->data, frame.dlc);
+
+    int count = decode_payload(first, payload->data, payload->len, decoded, DECODE_MAX_SIGNALS);
+    if (count < 0) {
+        report_decode_error(count, first, frame.id, payload->len);
+        return;
+    }
 
+    apply_decoded(&frame, decoded, count);
+}
+
+void parse_can_message(const CAN_Message *msg)
+{
+    DecodedSignal decoded[DECODE_MAX_SIGNALS];
+    TransportPayload payload;
+
+    /* Multi-frame transfers are decoded once complete. */
+    switch (transport_receive(msg, &payload)) {
+    case TRANSPORT_CONSUMED:
+        return;
+    case TRANSPORT_COMPLETE:
+        parse_transport_payload(&payload);
         return;
+    case TRANSPORT_PASS:
+        break;
     }
 
-    /* Unknown CAN ID */
-    printf("INFO: Unknown CAN ID 0x%03X ignored\n", msg->id);
+    int first = first_signal_for_frame(msg);
+    int count = decode_can_message(msg, decoded, DECODE_MAX_SIGNALS);
+
+    if (count < 0 && count != DECODE_E2E_CRC) {
+        report_decode_error(count, first, msg->id, msg->dlc);
+        return;
+    }
+
+    /* Reject frames failing E2E protection before they touch any state.
+     * The decoder checked the CRC; the alive counter needs per-ID state.
+     */
+    const CAN_SignalDef *message = &signal_table[first];
+    if (message->e2e.profile != E2E_NONE) {
+        E2EResult e2e = e2e_check(&message->e2e, msg, count != DECODE_E2E_CRC);
+        if (E2E_FAILED(e2e)) {
+            console_event(CONSOLE_EVENT_E2E, "ERROR: E2E check failed for %s (%s)",
+                          message->message_name, e2e_result_name(e2e));
+            return;
+        }
+    }
+
+    if (message->type == MSG_CAN)
+        supervision_frame_seen((uint16_t)msg->id);
+
+    apply_decoded(msg, decoded, count);
 }
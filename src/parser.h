@@ -1,8 +1,93 @@
 #ifndef PARSER_H
 #define PARSER_H
 #include "can_message.h"
+#include "signal_registry.h"
+#include "e2e.h"
 
-/* Parse and decode a received CAN message. */
+/* One decoded signal value. */
+typedef struct
+{
+    SignalHandle handle;        /* Registry handle */
+    const char  *name;
+    const char  *unit;
+    int64_t      raw;           /* Raw value the physical value was computed from */
+    float        value;         /* Physical value (scale and offset applied) */
+    int          out_of_range;  /* 1 if outside the signal's min/max */
+} DecodedSignal;
+
+/* Position of a signal in a payload. Up to SIGNAL_MAX_BITS bits.
+ *
+ *   SIGNAL_BIG_ENDIAN     start_bit is the most significant bit, counted
+ *                         from the most significant bit of byte 0 (bit 8
+ *                         is the MSB of byte 1). A DBC Motorola start bit
+ *                         s is 8 * (s / 8) + 7 - s % 8 here.
+ *   SIGNAL_LITTLE_ENDIAN  start_bit is the least significant bit, counted
+ *                         from the least significant bit of byte 0, as in
+ *                         DBC Intel signals.
+ */
+typedef enum
+{
+    SIGNAL_BIG_ENDIAN,
+    SIGNAL_LITTLE_ENDIAN
+} SignalByteOrder;
+
+#define SIGNAL_MAX_BITS 32
+
+typedef struct
+{
+    uint16_t start_bit;
+    uint8_t  bit_length;    /* 1 .. SIGNAL_MAX_BITS */
+    uint8_t  byte_order;    /* SignalByteOrder */
+    uint8_t  is_signed;     /* Two's complement */
+} SignalLayout;
+
+/* How one signal is decoded from a payload. */
+typedef struct
+{
+    SignalLayout layout;
+    uint16_t     dlc;       /* Payload length the message must have */
+    float        scale;
+    float        offset;
+    float        min;       /* Validation limits */
+    float        max;
+} SignalDef;
+
+#define DECODE_MAX_SIGNALS   8   /* Signals a single frame can carry */
+#define DECODE_UNKNOWN_ID   -1
+#define DECODE_DLC_MISMATCH -2
+#define DECODE_E2E_CRC      -3   /* E2E-protected message with a wrong CRC */
+
+/* Register all signals of the signal table and build the CAN ID index.
+ * Must be called once at startup, before any decoding.
+ * Returns 0 on success, -1 if the signal registry is full.
+ */
+int parser_init(void);
+
+/* Decode a CAN message without touching shared state. The CRC of
+ * E2E-protected messages is checked; alive counters are only tracked
+ * by parse_can_message().
+ * Returns the number of signals written to out (at most max),
+ * or DECODE_UNKNOWN_ID / DECODE_DLC_MISMATCH / DECODE_E2E_CRC.
+ */
+int decode_can_message(const CAN_Message *msg, DecodedSignal *out, int max);
+
+/* Raw value of a signal, sign-extended if it is signed. The payload must
+ * hold all bits of the signal. Used by the decoder for every signal.
+ */
+int64_t signal_extract_raw(const uint8_t *data, const SignalLayout *layout);
+
+/* Decode one signal: DLC check, raw value, scale and offset, range
+ * check. Sets raw, value and out_of_range of out. Returns 0, or
+ * DECODE_DLC_MISMATCH. Used by the decoder for every signal.
+ */
+int decode_signal(const SignalDef *def, const uint8_t *data, uint16_t len, DecodedSignal *out);
+
+/* E2E protection of a message, or NULL if it is unprotected. */
+const E2EConfig *parser_e2e_config(uint16_t id);
+
+/* Parse and decode a received CAN message; frames failing their E2E
+ * check are rejected before any state is updated.
+ */
 void parse_can_message(const CAN_Message *msg);
 
 #endif /* PARSER_H */
\ No newline at end of file
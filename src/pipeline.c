@@ -0,0 +1,295 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pipeline.h"
+#include "parser.h"
+#include "logger.h"
+#include "data_model.h"
+#include "udp_publisher.h"
+#include "platform.h"
+#include "realtime.h"
+#include "transport.h"
+#include "bus_analyzer.h"
+#include "console.h"
+
+#define CAN_ID_COUNT     0x800
+#define LATENCY_BUCKETS  1024   /* 1 µs each, the last one collects everything slower */
+
+typedef struct
+{
+    CAN_Message msg;
+    uint64_t    ingest_us;      /* Monotonic time the frame was queued */
+} IngestItem;
+
+/* Written by the decode thread only; readers may see slightly stale counts. */
+typedef struct
+{
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total;
+    uint64_t max_us;
+} LatencyHistogram;
+
+/* PIPELINE STATE */
+
+static BoundedQueue ingest_queue;
+static BoundedQueue sink_queue;
+static int          running = 0;
+
+static platform_thread_t decode_tid;
+static platform_thread_t sink_tid;
+
+static LatencyHistogram queue_latency;   /* Ingest to start of decode */
+static LatencyHistogram decode_latency;  /* Decode, live state update and sink hand-off */
+
+static void latency_record(LatencyHistogram *h, uint64_t us)
+{
+    h->counts[us < LATENCY_BUCKETS ? us : LATENCY_BUCKETS - 1]++;
+    h->total++;
+    if (us > h->max_us)
+        h->max_us = us;
+}
+
+/* Upper bound of the bucket holding quantile q. */
+static uint64_t latency_quantile(const LatencyHistogram *h, double q)
+{
+    uint64_t rank = (uint64_t)(q * h->total), seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen > rank)
+            return i + 1 < LATENCY_BUCKETS ? (uint64_t)i + 1 : h->max_us;
+    }
+    return h->max_us;
+}
+
+/* STAGES */
+
+static void deliver_to_sinks(const SinkRecord *rec)
+{
+    const CompressSample *s = &rec->sample;
+
+    log_can_message(&s->frame, rec->name, s->value, rec->unit, s->warning);
+
+    udp_publisher_add(rec->handle,
+            s->warning ? SIGNAL_FLAG_WARNING : 0,
+            s->value,
+            s->frame.timestamp_us);
+}
+
+static void decode_frame(const CAN_Message *msg)
+{
+    console_frame(msg);
+    parse_can_message(msg);
+}
+
+static void *decode_thread(void *arg)
+{
+    (void)arg;
+    IngestItem item;
+
+    realtime_enter_thread(RT_THREAD_DECODE);
+
+    while (queue_pop(&ingest_queue, &item)) {
+        uint64_t start = platform_time_us();
+        decode_frame(&item.msg);
+        uint64_t end = platform_time_us();
+
+        latency_record(&queue_latency, start - item.ingest_us);
+        latency_record(&decode_latency, end - start);
+    }
+
+    return NULL;
+}
+
+static void *sink_thread(void *arg)
+{
+    (void)arg;
+    SinkRecord rec;
+
+    while (1) {
+        if (!queue_try_pop(&sink_queue, &rec)) {
+            /* Idle: send what is batched instead of waiting for more. */
+            udp_publisher_flush();
+            if (!queue_pop(&sink_queue, &rec))
+                break;
+        }
+        deliver_to_sinks(&rec);
+    }
+
+    udp_publisher_flush();
+    return NULL;
+}
+
+/* PUBLIC API */
+
+void pipeline_default_config(PipelineConfig *cfg)
+{
+    cfg->ingest.policy   = QUEUE_KEEP_LATEST;
+    cfg->ingest.capacity = PIPELINE_INGEST_DEFAULT_CAPACITY;
+    cfg->sink.policy     = QUEUE_DROP_OLDEST;
+    cfg->sink.capacity   = PIPELINE_SINK_DEFAULT_CAPACITY;
+}
+
+int pipeline_parse_queue_option(PipelineConfig *cfg, const char *text)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s", text);
+
+    char *eq = strchr(buf, '=');
+    if (!eq)
+        return -1;
+    *eq = '\0';
+
+    QueueConfig *qc;
+    if (strcmp(buf, "ingest") == 0)
+        qc = &cfg->ingest;
+    else if (strcmp(buf, "sink") == 0)
+        qc = &cfg->sink;
+    else
+        return -1;
+
+    char *colon = strchr(eq + 1, ':');
+    if (colon) {
+        *colon = '\0';
+        int capacity = atoi(colon + 1);
+        if (capacity <= 0)
+            return -1;
+        qc->capacity = capacity;
+    }
+
+    return queue_parse_policy(eq + 1, &qc->policy);
+}
+
+int pipeline_start(const PipelineConfig *cfg)
+{
+    if (queue_init(&ingest_queue, "ingest", cfg->ingest.policy, cfg->ingest.capacity,
+                   sizeof(IngestItem), CAN_ID_COUNT) < 0 ||
+        queue_init(&sink_queue, "sink", cfg->sink.policy, cfg->sink.capacity,
+                   sizeof(SinkRecord), MAX_SIGNALS) < 0) {
+        printf("ERROR: Cannot allocate pipeline queues\n");
+        return -1;
+    }
+
+    /* A replaced frame keeps its place, so it also keeps its queueing time. */
+    queue_keep_on_replace(&ingest_queue, offsetof(IngestItem, ingest_us), sizeof(uint64_t));
+
+    if (realtime_enabled()) {
+        realtime_prefault(ingest_queue.items, (size_t)ingest_queue.capacity * ingest_queue.item_size);
+        realtime_prefault(sink_queue.items, (size_t)sink_queue.capacity * sink_queue.item_size);
+        realtime_prefault(&queue_latency, sizeof(queue_latency));
+        realtime_prefault(&decode_latency, sizeof(decode_latency));
+    }
+
+    /* Set before the threads start so samples decoded there are queued. */
+    running = 1;
+
+    if (platform_thread_start(&sink_tid, sink_thread, NULL) < 0 ||
+        platform_thread_start(&decode_tid, decode_thread, NULL) < 0) {
+        printf("ERROR: Cannot start pipeline threads\n");
+        running = 0;
+        return -1;
+    }
+
+    printf("Pipeline: ingest queue %s/%d, sink queue %s/%d\n",
+           queue_policy_name(cfg->ingest.policy), cfg->ingest.capacity,
+           queue_policy_name(cfg->sink.policy), cfg->sink.capacity);
+    return 0;
+}
+
+void pipeline_ingest(const CAN_Message *msg)
+{
+    /* Before any queue, so the analysis sees the bus and not our drops. */
+    bus_analyzer_frame(msg);
+
+    if (running) {
+        IngestItem item = { *msg, platform_time_us() };
+
+        /* Every frame of a transfer must reach the decoder, E2E alive
+         * counters must see every frame, and extended IDs do not fit the
+         * key range: never merge those.
+         */
+        uint32_t key = ((msg->id & CAN_EFF_FLAG) || transport_is_segmented(msg) ||
+                        parser_e2e_config((uint16_t)msg->id))
+                     ? QUEUE_KEY_NONE : msg->id;
+        queue_push(&ingest_queue, &item, key);
+    }
+    else
+        decode_frame(msg);
+}
+
+void pipeline_sink(const SinkRecord *rec)
+{
+    if (running)
+        queue_push(&sink_queue, rec, rec->handle);
+    else
+        deliver_to_sinks(rec);
+}
+
+/* METRICS */
+
+static int write_queue_metrics(BoundedQueue *q, char *buf, size_t len)
+{
+    QueueStats st;
+    queue_get_stats(q, &st);
+
+    return snprintf(buf, len,
+                    "can_queue_depth{queue=\"%s\"} %d\n"
+                    "can_queue_capacity{queue=\"%s\",policy=\"%s\"} %d\n"
+                    "can_queue_high_watermark{queue=\"%s\"} %d\n"
+                    "can_queue_pushed_total{queue=\"%s\"} %llu\n"
+                    "can_queue_blocked_total{queue=\"%s\"} %llu\n"
+                    "can_queue_dropped_total{queue=\"%s\",reason=\"oldest\"} %llu\n"
+                    "can_queue_dropped_total{queue=\"%s\",reason=\"newest\"} %llu\n"
+                    "can_queue_dropped_total{queue=\"%s\",reason=\"replaced\"} %llu\n",
+                    q->name, st.depth,
+                    q->name, queue_policy_name(q->policy), q->capacity,
+                    q->name, st.high_watermark,
+                    q->name, (unsigned long long)st.pushed,
+                    q->name, (unsigned long long)st.blocked,
+                    q->name, (unsigned long long)st.dropped_oldest,
+                    q->name, (unsigned long long)st.dropped_newest,
+                    q->name, (unsigned long long)st.replaced);
+}
+
+static int write_latency_metrics(const char *stage, const LatencyHistogram *h, char *buf, size_t len)
+{
+    return snprintf(buf, len,
+                    "can_pipeline_latency_us{stage=\"%s\",quantile=\"0.5\"} %llu\n"
+                    "can_pipeline_latency_us{stage=\"%s\",quantile=\"0.99\"} %llu\n"
+                    "can_pipeline_latency_us{stage=\"%s\",quantile=\"0.999\"} %llu\n"
+                    "can_pipeline_latency_max_us{stage=\"%s\"} %llu\n",
+                    stage, (unsigned long long)latency_quantile(h, 0.5),
+                    stage, (unsigned long long)latency_quantile(h, 0.99),
+                    stage, (unsigned long long)latency_quantile(h, 0.999),
+                    stage, (unsigned long long)h->max_us);
+}
+
+int pipeline_write_metrics(char *buf, size_t len)
+{
+    if (!running)
+        return 0;
+
+    int off = snprintf(buf, len,
+                       "# TYPE can_queue_depth gauge\n"
+                       "# TYPE can_queue_capacity gauge\n"
+                       "# TYPE can_queue_high_watermark gauge\n"
+                       "# TYPE can_queue_pushed_total counter\n"
+                       "# TYPE can_queue_blocked_total counter\n"
+                       "# TYPE can_queue_dropped_total counter\n");
+
+    if (off > 0 && (size_t)off < len)
+        off += write_queue_metrics(&ingest_queue, buf + off, len - off);
+    if (off > 0 && (size_t)off < len)
+        off += write_queue_metrics(&sink_queue, buf + off, len - off);
+    if (off > 0 && (size_t)off < len)
+        off += snprintf(buf + off, len - off,
+                        "# TYPE can_pipeline_latency_us gauge\n"
+                        "# TYPE can_pipeline_latency_max_us gauge\n");
+    if (off > 0 && (size_t)off < len)
+        off += write_latency_metrics("queue", &queue_latency, buf + off, len - off);
+    if (off > 0 && (size_t)off < len)
+        off += write_latency_metrics("decode", &decode_latency, buf + off, len - off);
+
+    return (off > 0 && (size_t)off < len) ? off : (int)(len ? len - 1 : 0);
+}
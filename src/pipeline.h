@@ -0,0 +1,68 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+
+#include "bounded_queue.h"
+#include "compression.h"
+#include "signal_registry.h"
+
+/* Decoupled stages of the live path:
+ *
+ *   ingest --[ingest queue]--> decode thread --[sink queue]--> sink thread
+ *   (simulator)                (parse, live state,             (log file, UDP)
+ *                               compression)
+ *
+ * The live state (g_vehicle_data, shared memory) is updated by the
+ * decode thread, so a slow log file only ever costs log detail.
+ * Before pipeline_start() both entry points run their stage inline.
+ */
+
+#define PIPELINE_INGEST_DEFAULT_CAPACITY  256
+#define PIPELINE_SINK_DEFAULT_CAPACITY    1024
+
+typedef struct
+{
+    QueuePolicy policy;
+    int         capacity;
+} QueueConfig;
+
+typedef struct
+{
+    QueueConfig ingest;   /* Frames waiting to be decoded, keyed by CAN ID */
+    QueueConfig sink;     /* Samples waiting for log/UDP, keyed by signal */
+} PipelineConfig;
+
+/* A compressed sample on its way to the sinks. */
+typedef struct
+{
+    CompressSample sample;
+    SignalHandle   handle;
+    const char    *name;
+    const char    *unit;
+} SinkRecord;
+
+/* Defaults: ingest keeps the latest frame per ID, sinks drop the oldest. */
+void pipeline_default_config(PipelineConfig *cfg);
+
+/* Parse "<ingest|sink>=<policy>[:<capacity>]" into cfg. Returns 0 on success. */
+int pipeline_parse_queue_option(PipelineConfig *cfg, const char *text);
+
+/* Allocate the queues and start the decode and sink threads.
+ * Returns 0 on success, -1 on failure.
+ */
+int pipeline_start(const PipelineConfig *cfg);
+
+/* Hand a received frame to the decoder. */
+void pipeline_ingest(const CAN_Message *msg);
+
+/* Hand a decoded, compressed sample to the sinks. */
+void pipeline_sink(const SinkRecord *rec);
+
+/* Writes per-queue depth, high watermark and drop counters, and the
+ * queueing and decode latency (median, p99, p999, worst case) in
+ * Prometheus text format. Returns bytes written.
+ */
+int pipeline_write_metrics(char *buf, size_t len);
+
+#endif /* PIPELINE_H */
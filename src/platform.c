@@ -0,0 +1,162 @@
+#include <stdlib.h>
+
+#include "platform.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#endif
+
+uint64_t platform_time_us(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000u +
+           (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000u / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
+
+uint64_t platform_wall_time_us(void)
+{
+#ifdef _WIN32
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+
+    /* 100 ns ticks since 1601-01-01 */
+    uint64_t ticks = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return ticks / 10u - 11644473600000000ull;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000u + (uint64_t)tv.tv_usec;
+#endif
+}
+
+/* THREADS */
+
+#ifdef _WIN32
+typedef struct
+{
+    platform_thread_fn fn;
+    void              *arg;
+} ThreadStart;
+
+static DWORD WINAPI thread_trampoline(LPVOID param)
+{
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.fn(start.arg);
+    return 0;
+}
+#endif
+
+int platform_thread_start(platform_thread_t *thread, platform_thread_fn fn, void *arg)
+{
+#ifdef _WIN32
+    ThreadStart *start = malloc(sizeof(*start));
+    if (!start)
+        return -1;
+    start->fn  = fn;
+    start->arg = arg;
+
+    *thread = CreateThread(NULL, 0, thread_trampoline, start, 0, NULL);
+    if (*thread == NULL) {
+        free(start);
+        return -1;
+    }
+    return 0;
+#else
+    return pthread_create(thread, NULL, fn, arg) == 0 ? 0 : -1;
+#endif
+}
+
+void platform_thread_join(platform_thread_t thread)
+{
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+/* SYNCHRONIZATION */
+
+void platform_mutex_init(platform_mutex_t *mutex)
+{
+#ifdef _WIN32
+    InitializeSRWLock((PSRWLOCK)mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void platform_mutex_lock(platform_mutex_t *mutex)
+{
+#ifdef _WIN32
+    AcquireSRWLockExclusive((PSRWLOCK)mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void platform_mutex_unlock(platform_mutex_t *mutex)
+{
+#ifdef _WIN32
+    ReleaseSRWLockExclusive((PSRWLOCK)mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+void platform_cond_init(platform_cond_t *cond)
+{
+#ifdef _WIN32
+    InitializeConditionVariable((PCONDITION_VARIABLE)cond);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
+}
+
+void platform_cond_wait(platform_cond_t *cond, platform_mutex_t *mutex)
+{
+#ifdef _WIN32
+    SleepConditionVariableSRW((PCONDITION_VARIABLE)cond, (PSRWLOCK)mutex, INFINITE, 0);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
+
+void platform_cond_broadcast(platform_cond_t *cond)
+{
+#ifdef _WIN32
+    WakeAllConditionVariable((PCONDITION_VARIABLE)cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+int platform_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
@@ -0,0 +1,42 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdint.h>
+
+#ifdef _WIN32
+typedef void *platform_thread_t;    /* Windows HANDLE */
+typedef void *platform_mutex_t;     /* SRWLOCK */
+typedef void *platform_cond_t;      /* CONDITION_VARIABLE */
+#else
+#include <pthread.h>
+typedef pthread_t       platform_thread_t;
+typedef pthread_mutex_t platform_mutex_t;
+typedef pthread_cond_t  platform_cond_t;
+#endif
+
+typedef void *(*platform_thread_fn)(void *arg);
+
+/* Monotonic time in microseconds (arbitrary epoch). */
+uint64_t platform_time_us(void);
+
+/* Wall-clock time in microseconds since the Unix epoch. */
+uint64_t platform_wall_time_us(void);
+
+/* Start a thread running fn(arg). Returns 0 on success, -1 on failure. */
+int platform_thread_start(platform_thread_t *thread, platform_thread_fn fn, void *arg);
+
+/* Wait for a thread started with platform_thread_start to finish. */
+void platform_thread_join(platform_thread_t thread);
+
+/* Mutex and condition variable (not recursive, never destroyed). */
+void platform_mutex_init(platform_mutex_t *mutex);
+void platform_mutex_lock(platform_mutex_t *mutex);
+void platform_mutex_unlock(platform_mutex_t *mutex);
+void platform_cond_init(platform_cond_t *cond);
+void platform_cond_wait(platform_cond_t *cond, platform_mutex_t *mutex);
+void platform_cond_broadcast(platform_cond_t *cond);
+
+/* Number of online CPUs (at least 1). */
+int platform_cpu_count(void);
+
+#endif /* PLATFORM_H */
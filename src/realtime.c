@@ -0,0 +1,134 @@
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "realtime.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#endif
+
+#define PREFAULT_PAGE_SIZE   4096
+#define PREFAULT_STACK_SIZE  (64 * 1024)
+
+static const char *thread_names[RT_THREAD_COUNT] = { "ingest", "decode" };
+
+static RealtimeConfig config;
+
+/* PUBLIC API */
+
+void realtime_default_config(RealtimeConfig *cfg)
+{
+    cfg->enabled       = 0;
+    cfg->fifo_priority = 0;
+    for (int i = 0; i < RT_THREAD_COUNT; i++)
+        cfg->cpu[i] = -1;
+}
+
+int realtime_parse_cpus(RealtimeConfig *cfg, const char *text)
+{
+    char *end;
+    long ingest = strtol(text, &end, 10);
+    if (*end != ',' || ingest < 0)
+        return -1;
+    long decode = strtol(end + 1, &end, 10);
+    if (*end != '\0' || decode < 0)
+        return -1;
+
+    cfg->cpu[RT_THREAD_INGEST] = (int)ingest;
+    cfg->cpu[RT_THREAD_DECODE] = (int)decode;
+    return 0;
+}
+
+void realtime_init(const RealtimeConfig *cfg)
+{
+    config = *cfg;
+    if (!config.enabled)
+        return;
+
+#ifdef _WIN32
+    printf("WARNING: Memory locking is not supported on Windows\n");
+#else
+#ifdef __GLIBC__
+    /* Keep freed memory in the (locked) heap instead of returning it to the OS. */
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+#endif
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+        printf("WARNING: mlockall failed (%s), memory may be paged\n", strerror(errno));
+#endif
+
+    printf("Realtime mode: ingest cpu %d, decode cpu %d, %s\n",
+           config.cpu[RT_THREAD_INGEST], config.cpu[RT_THREAD_DECODE],
+           config.fifo_priority > 0 ? "SCHED_FIFO" : "default scheduler");
+}
+
+int realtime_enabled(void)
+{
+    return config.enabled;
+}
+
+void realtime_enter_thread(RealtimeThread thread)
+{
+    if (!config.enabled)
+        return;
+
+    int cpu = config.cpu[thread];
+
+#ifdef _WIN32
+    if (cpu >= 0 && !SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu))
+        printf("WARNING: Cannot pin %s thread to cpu %d\n", thread_names[thread], cpu);
+    if (config.fifo_priority > 0)
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#else
+#ifdef __linux__
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err)
+            printf("WARNING: Cannot pin %s thread to cpu %d (%s)\n",
+                   thread_names[thread], cpu, strerror(err));
+    }
+#else
+    if (cpu >= 0)
+        printf("WARNING: CPU pinning is not supported on this platform\n");
+#endif
+    if (config.fifo_priority > 0) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = config.fifo_priority;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err)
+            printf("WARNING: Cannot use SCHED_FIFO for %s thread (%s)\n",
+                   thread_names[thread], strerror(err));
+    }
+#endif
+
+    /* Fault in the stack the thread is going to use. */
+    volatile char stack[PREFAULT_STACK_SIZE];
+    for (size_t i = 0; i < sizeof(stack); i += PREFAULT_PAGE_SIZE)
+        stack[i] = 0;
+}
+
+void realtime_prefault(void *buf, size_t len)
+{
+    volatile char *p = buf;
+    for (size_t i = 0; i < len; i += PREFAULT_PAGE_SIZE)
+        p[i] = p[i];
+    if (len > 0)
+        p[len - 1] = p[len - 1];
+}
@@ -0,0 +1,49 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <stddef.h>
+
+/* Opt-in latency-deterministic runtime mode.
+ *
+ * When enabled, memory is locked (mlockall) before the pipeline buffers
+ * are allocated, those buffers are pre-faulted, and the ingest and
+ * decode threads pin themselves to their configured CPUs and optionally
+ * switch to SCHED_FIFO. Failures (e.g. missing privileges) are reported
+ * as warnings and the program continues without that guarantee.
+ */
+
+typedef enum
+{
+    RT_THREAD_INGEST,
+    RT_THREAD_DECODE,
+    RT_THREAD_COUNT
+} RealtimeThread;
+
+typedef struct
+{
+    int enabled;
+    int cpu[RT_THREAD_COUNT];   /* -1 = not pinned */
+    int fifo_priority;          /* 0 = default scheduler, 1..99 = SCHED_FIFO */
+} RealtimeConfig;
+
+void realtime_default_config(RealtimeConfig *cfg);
+
+/* Parse "<ingest_cpu>,<decode_cpu>" into cfg. Returns 0 on success. */
+int realtime_parse_cpus(RealtimeConfig *cfg, const char *text);
+
+/* Lock current and future memory. Call before allocating the pipeline.
+ * Does nothing unless cfg->enabled.
+ */
+void realtime_init(const RealtimeConfig *cfg);
+
+int realtime_enabled(void);
+
+/* Apply CPU pinning and scheduling to the calling thread and pre-fault
+ * its stack. Does nothing unless realtime mode is enabled.
+ */
+void realtime_enter_thread(RealtimeThread thread);
+
+/* Touch every page of a buffer so the hot path never page-faults on it. */
+void realtime_prefault(void *buf, size_t len);
+
+#endif /* REALTIME_H */
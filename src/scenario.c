@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scenario.h"
+#include "parser.h"
+#include "platform.h"
+#include "console.h"
+
+typedef enum
+{
+    PHASE_NORMAL,
+    PHASE_BURST,
+    PHASE_SILENCE
+} PhaseKind;
+
+static const char *phase_names[] = { "normal", "burst", "silence" };
+
+typedef struct
+{
+    PhaseKind kind;
+    uint64_t  duration_us;
+    uint32_t  rate;         /* Burst frames per second, 0 = full bus load */
+    float     drop;
+    float     dup;
+    float     bad_dlc;
+    float     unknown_id;
+    float     reorder;
+    float     bit_flip;
+} ScenarioPhase;
+
+typedef enum
+{
+    FAULT_DROP,
+    FAULT_DUPLICATE,
+    FAULT_BAD_DLC,
+    FAULT_UNKNOWN_ID,
+    FAULT_REORDER,
+    FAULT_BIT_FLIP,
+    FAULT_COUNT
+} FaultKind;
+
+static const char *fault_names[FAULT_COUNT] = {
+    "drop", "duplicate", "bad_dlc", "unknown_id", "reorder", "bit_flip"
+};
+
+/* SCENARIO STATE */
+
+static ScenarioPhase phases[SCENARIO_MAX_PHASES];
+static int           phase_count = 0;
+static int           current = -1;
+static uint64_t      phase_end_us = 0;
+
+static uint64_t clock_us = 0;       /* Scenario time since start */
+static uint64_t start_mono_us = 0;
+static uint64_t start_wall_us = 0;
+static uint64_t rng_state = 0;
+
+static CAN_Message held;
+static int         have_held = 0;
+
+static uint64_t frames_generated = 0;
+static uint64_t frames_sent = 0;
+static uint64_t faults[FAULT_COUNT];
+
+/* RANDOM NUMBERS (xorshift64*, seeded through splitmix64) */
+
+static void rng_seed(uint32_t seed)
+{
+    uint64_t z = (uint64_t)seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    rng_state = (z ^ (z >> 31)) | 1;
+}
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static int chance(float p)
+{
+    /* Always draw, so the sequence does not depend on which faults are enabled. */
+    uint32_t r = rng_next();
+    return p > 0.0f && r < (uint32_t)(p * 4294967295.0);
+}
+
+/* SCRIPT PARSING */
+
+static int parse_phase(char *line, ScenarioPhase *ph)
+{
+    char *kind = strtok(line, " \t");
+    char *secs = strtok(NULL, " \t");
+    if (!kind || !secs)
+        return -1;
+
+    memset(ph, 0, sizeof(*ph));
+    if (strcmp(kind, "normal") == 0)
+        ph->kind = PHASE_NORMAL;
+    else if (strcmp(kind, "burst") == 0)
+        ph->kind = PHASE_BURST;
+    else if (strcmp(kind, "silence") == 0)
+        ph->kind = PHASE_SILENCE;
+    else
+        return -1;
+
+    char *end;
+    double seconds = strtod(secs, &end);
+    if (*end != '\0' || seconds <= 0.0)
+        return -1;
+    ph->duration_us = (uint64_t)(seconds * 1000000.0);
+
+    for (char *kv = strtok(NULL, " \t"); kv; kv = strtok(NULL, " \t")) {
+        char *eq = strchr(kv, '=');
+        if (!eq)
+            return -1;
+        *eq = '\0';
+        double v = strtod(eq + 1, &end);
+        if (*end != '\0' || v < 0.0)
+            return -1;
+
+        if (strcmp(kv, "rate") == 0)
+            ph->rate = (uint32_t)v;
+        else if (v > 1.0)
+            return -1;
+        else if (strcmp(kv, "drop") == 0)
+            ph->drop = (float)v;
+        else if (strcmp(kv, "dup") == 0)
+            ph->dup = (float)v;
+        else if (strcmp(kv, "dlc") == 0)
+            ph->bad_dlc = (float)v;
+        else if (strcmp(kv, "unknown") == 0)
+            ph->unknown_id = (float)v;
+        else if (strcmp(kv, "reorder") == 0)
+            ph->reorder = (float)v;
+        else if (strcmp(kv, "flip") == 0)
+            ph->bit_flip = (float)v;
+        else
+            return -1;
+    }
+    return 0;
+}
+
+int scenario_load(const char *path, uint32_t seed)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        printf("ERROR: Cannot open scenario %s\n", path);
+        return -1;
+    }
+
+    char line[256];
+    int line_no = 0;
+    phase_count = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        if (strspn(line, " \t") == strlen(line))
+            continue;
+
+        if (phase_count == SCENARIO_MAX_PHASES) {
+            printf("ERROR: %s:%d: more than %d phases\n", path, line_no, SCENARIO_MAX_PHASES);
+            fclose(fp);
+            return -1;
+        }
+        if (parse_phase(line, &phases[phase_count]) < 0) {
+            printf("ERROR: %s:%d: expected '<normal|burst|silence> <seconds> [key=value ...]'\n",
+                   path, line_no);
+            fclose(fp);
+            return -1;
+        }
+        phase_count++;
+    }
+    fclose(fp);
+
+    if (phase_count == 0) {
+        printf("ERROR: Scenario %s has no phases\n", path);
+        return -1;
+    }
+
+    rng_seed(seed);
+    current       = -1;
+    phase_end_us  = 0;
+    clock_us      = 0;
+    have_held     = 0;
+
+    printf("Scenario %s loaded (%d phases, seed %lu)\n", path, phase_count, (unsigned long)seed);
+    return 0;
+}
+
+int scenario_active(void)
+{
+    return phase_count > 0;
+}
+
+/* FAULT INJECTION */
+
+/* Worst-case bit length of a standard data frame including stuff bits. */
+static uint32_t frame_bits(uint8_t dlc)
+{
+    uint32_t bits = 47u + 8u * dlc;
+    return bits + (34u + 8u * dlc - 1u) / 4u;
+}
+
+static void enter_next_phase(void)
+{
+    current = (current + 1) % phase_count;
+    phase_end_us += phases[current].duration_us;
+
+    const ScenarioPhase *ph = &phases[current];
+    console_event(CONSOLE_EVENT_INFO, "SCENARIO: phase %d/%d %s %.2f s", current + 1, phase_count,
+                  phase_names[ph->kind], ph->duration_us / 1000000.0);
+}
+
+static uint64_t frame_gap_us(const ScenarioPhase *ph, const CAN_Message *msg)
+{
+    if (ph->kind == PHASE_NORMAL)
+        return SCENARIO_NORMAL_GAP_US;
+    if (ph->rate > 0)
+        return 1000000u / ph->rate;
+    return (uint64_t)frame_bits(msg->dlc) * 1000000u / SCENARIO_BUS_BITRATE;
+}
+
+static void corrupt_dlc(CAN_Message *msg)
+{
+    uint8_t dlc = (uint8_t)(rng_next() % 8);
+    msg->dlc = dlc >= msg->dlc ? dlc + 1 : dlc;   /* Any DLC but the right one */
+}
+
+static void corrupt_id(CAN_Message *msg)
+{
+    DecodedSignal scratch[DECODE_MAX_SIGNALS];
+
+    for (int attempt = 0; attempt < 16; attempt++) {
+        msg->id = (uint16_t)(rng_next() & 0x7FF);
+        if (decode_can_message(msg, scratch, DECODE_MAX_SIGNALS) == DECODE_UNKNOWN_ID)
+            return;
+    }
+    msg->id = 0x7FF;
+}
+
+int scenario_apply(const CAN_Message *in, CAN_Message *out)
+{
+    /* The scenario clock starts with the first frame. */
+    if (current < 0) {
+        start_mono_us = platform_time_us();
+        start_wall_us = platform_wall_time_us();
+    }
+    if (current < 0 || clock_us >= phase_end_us)
+        enter_next_phase();
+
+    const ScenarioPhase *ph = &phases[current];
+    frames_generated++;
+
+    if (ph->kind == PHASE_SILENCE) {
+        clock_us = phase_end_us;
+        return 0;
+    }
+
+    CAN_Message frame = *in;
+    frame.timestamp_us = start_wall_us + clock_us;
+    clock_us += frame_gap_us(ph, &frame);
+
+    int dropped = chance(ph->drop);
+    int bad_dlc = chance(ph->bad_dlc);
+    int unknown = chance(ph->unknown_id);
+    int reorder = chance(ph->reorder);
+    int dup     = chance(ph->dup);
+    int flip    = chance(ph->bit_flip);
+
+    int n = 0;
+    if (dropped) {
+        faults[FAULT_DROP]++;
+    }
+    else {
+        if (bad_dlc) {
+            corrupt_dlc(&frame);
+            faults[FAULT_BAD_DLC]++;
+        }
+        if (unknown) {
+            corrupt_id(&frame);
+            faults[FAULT_UNKNOWN_ID]++;
+        }
+        if (flip && frame.dlc > 0) {
+            uint32_t bit = rng_next() % (frame.dlc * 8u);
+            frame.data[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+            faults[FAULT_BIT_FLIP]++;
+        }
+
+        if (reorder && !have_held) {
+            held = frame;
+            have_held = 1;
+            faults[FAULT_REORDER]++;
+            return 0;
+        }
+
+        out[n++] = frame;
+        if (dup) {
+            out[n++] = frame;
+            faults[FAULT_DUPLICATE]++;
+        }
+    }
+
+    /* A held frame goes out right after the next delivered one. */
+    if (have_held && n > 0) {
+        out[n++] = held;
+        have_held = 0;
+    }
+
+    frames_sent += n;
+    return n;
+}
+
+uint64_t scenario_delay_us(void)
+{
+    uint64_t due = start_mono_us + clock_us;
+    uint64_t now = platform_time_us();
+    return due > now ? due - now : 0;
+}
+
+/* METRICS */
+
+int scenario_write_metrics(char *buf, size_t len)
+{
+    if (!scenario_active())
+        return 0;
+
+    int off = snprintf(buf, len,
+                       "# TYPE can_sim_frames_generated_total counter\n"
+                       "can_sim_frames_generated_total %llu\n"
+                       "# TYPE can_sim_frames_sent_total counter\n"
+                       "can_sim_frames_sent_total %llu\n"
+                       "# TYPE can_sim_phase gauge\n"
+                       "can_sim_phase{kind=\"%s\"} %d\n"
+                       "# TYPE can_sim_faults_total counter\n",
+                       (unsigned long long)frames_generated,
+                       (unsigned long long)frames_sent,
+                       current >= 0 ? phase_names[phases[current].kind] : "none", current + 1);
+
+    for (int i = 0; i < FAULT_COUNT && off > 0 && (size_t)off < len; i++) {
+        off += snprintf(buf + off, len - off, "can_sim_faults_total{fault=\"%s\"} %llu\n",
+                        fault_names[i], (unsigned long long)faults[i]);
+    }
+
+    return (off > 0 && (size_t)off < len) ? off : (int)(len ? len - 1 : 0);
+}
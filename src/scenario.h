@@ -0,0 +1,59 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_message.h"
+
+/* Fault-injection scenarios for the simulator.
+ *
+ * A scenario script is a list of phases, one per line, played in order
+ * and then repeated:
+ *
+ *   # kind    seconds  [key=value ...]
+ *   normal    5
+ *   burst     2        rate=0 dup=0.05
+ *   normal    10       drop=0.1 dlc=0.02 unknown=0.05 reorder=0.05 flip=0.01
+ *   silence   3
+ *
+ * normal   frames at the regular simulator cadence (100 ms per frame)
+ * burst    frames back to back; rate=<frames/s>, 0 (default) = full bus load
+ * silence  no frames at all
+ *
+ * Fault probabilities (0..1) apply per generated frame in any phase:
+ * drop, dup (sent twice), dlc (wrong DLC), unknown (ID without signal
+ * definitions), reorder (delivered after the next frame, so its
+ * timestamp goes backwards) and flip (one payload bit inverted).
+ *
+ * Phase boundaries and frame timestamps follow a scenario clock, not the
+ * wall clock, so the same script and seed always produce the same frames.
+ */
+
+#define SCENARIO_MAX_PHASES    32
+#define SCENARIO_MAX_OUT       3        /* Frames produced per generated frame */
+#define SCENARIO_NORMAL_GAP_US 100000
+#define SCENARIO_BUS_BITRATE   500000   /* Bit rate assumed for full bus load */
+
+/* Load a scenario script. Returns 0 on success, -1 on a missing file
+ * or syntax error (reported on stdout).
+ */
+int scenario_load(const char *path, uint32_t seed);
+
+/* Non-zero once a scenario is loaded. */
+int scenario_active(void);
+
+/* Run one generated frame through the current phase. Writes the frames
+ * to deliver (0..SCENARIO_MAX_OUT) to out and returns their number.
+ */
+int scenario_apply(const CAN_Message *in, CAN_Message *out);
+
+/* Microseconds until the scenario clock allows the next frame. */
+uint64_t scenario_delay_us(void);
+
+/* Writes generated/sent frame and injected fault counters in
+ * Prometheus text format. Returns bytes written.
+ */
+int scenario_write_metrics(char *buf, size_t len);
+
+#endif /* SCENARIO_H */
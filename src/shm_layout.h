@@ -0,0 +1,48 @@
+#ifndef SHM_LAYOUT_H
+#define SHM_LAYOUT_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Layout of the shared-memory segment holding the live vehicle state.
+ *
+ * The segment is a ShmHeader followed by record_count ShmRecords, one
+ * per signal handle. Each record is guarded by its own seqlock: the
+ * writer makes seq odd, updates the record and makes it even again;
+ * a reader retries until it sees the same even seq before and after
+ * copying. Readers never block the writer and need no syscall.
+ *
+ * Consumers should check magic and version and then use header_size,
+ * record_size and record_count from the header instead of sizeof(), so
+ * a newer writer can append fields without breaking them.
+ */
+
+#define SHM_MAGIC           0x53434E43u          /* "CNCS" */
+#define SHM_LAYOUT_VERSION  1
+#define SHM_DEFAULT_NAME    "/can_vehicle_state"
+
+typedef struct
+{
+    uint32_t magic;          /* SHM_MAGIC, written last during creation */
+    uint16_t version;        /* SHM_LAYOUT_VERSION */
+    uint16_t header_size;    /* Offset of the first record */
+    uint32_t record_size;    /* Stride between records */
+    uint32_t record_count;   /* Number of records (signals) */
+    uint64_t writer_pid;
+    uint64_t created_us;     /* Wall-clock creation time */
+    uint8_t  reserved[32];
+} ShmHeader;                 /* 64 bytes */
+
+typedef struct
+{
+    _Atomic uint32_t seq;    /* Seqlock, odd while an update is in progress */
+    uint8_t  flags;          /* SIGNAL_FLAG_* */
+    uint8_t  reserved[3];
+    float    value;          /* Latest physical value */
+    uint32_t padding;
+    uint64_t timestamp_us;   /* Frame time of the value (µs since the Unix epoch) */
+    char     name[32];       /* Static metadata, written once at creation */
+    char     unit[8];
+} ShmRecord;                 /* 64 bytes, one cache line */
+
+#endif /* SHM_LAYOUT_H */
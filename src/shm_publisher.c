@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "shm_publisher.h"
+#include "shm_layout.h"
+#include "platform.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+/* WRITER STATE */
+
+static uint8_t   *segment = NULL;
+static size_t     segment_size = 0;
+static ShmRecord *records = NULL;
+static int        record_count = 0;
+static char       segment_name[64];
+static platform_mutex_t write_lock;  /* Decode and supervision threads both write */
+#ifdef _WIN32
+static HANDLE     mapping = NULL;
+#endif
+
+static void *map_segment(const char *name, size_t size)
+{
+#ifdef _WIN32
+    char local_name[80];
+    snprintf(local_name, sizeof(local_name), "Local\\%s", name[0] == '/' ? name + 1 : name);
+
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                 0, (DWORD)size, local_name);
+    if (!mapping)
+        return NULL;
+    void *p = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!p) {
+        CloseHandle(mapping);
+        mapping = NULL;
+    }
+    return p;
+#else
+    /* Start from a fresh object so readers never see a stale layout. */
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)size) < 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(name);
+        return NULL;
+    }
+    return p;
+#endif
+}
+
+/* PUBLIC API */
+
+int shm_publisher_init(const char *name)
+{
+    int count = signal_count();
+    size_t size = sizeof(ShmHeader) + (size_t)count * sizeof(ShmRecord);
+
+    uint8_t *p = map_segment(name, size);
+    if (!p) {
+        printf("ERROR: Could not create shared memory segment %s\n", name);
+        return -1;
+    }
+    memset(p, 0, size);
+
+    ShmRecord *r = (ShmRecord *)(p + sizeof(ShmHeader));
+    for (int i = 0; i < count; i++) {
+        const SignalInfo *info = signal_info((SignalHandle)i);
+        atomic_init(&r[i].seq, 0);
+        snprintf(r[i].name, sizeof(r[i].name), "%s", info->name);
+        snprintf(r[i].unit, sizeof(r[i].unit), "%s", info->unit);
+    }
+
+    ShmHeader *h = (ShmHeader *)p;
+    h->version      = SHM_LAYOUT_VERSION;
+    h->header_size  = sizeof(ShmHeader);
+    h->record_size  = sizeof(ShmRecord);
+    h->record_count = (uint32_t)count;
+    h->writer_pid   = (uint64_t)getpid();
+    h->created_us   = platform_wall_time_us();
+
+    /* Publish the magic last: a reader that sees it sees a complete layout. */
+    atomic_thread_fence(memory_order_release);
+    h->magic = SHM_MAGIC;
+
+    platform_mutex_init(&write_lock);
+    segment      = p;
+    segment_size = size;
+    records      = r;
+    record_count = count;
+    snprintf(segment_name, sizeof(segment_name), "%s", name);
+
+    printf("Shared memory state published at %s (%d signals, %zu bytes)\n",
+           name, count, size);
+    return 0;
+}
+
+void shm_publisher_update(SignalHandle handle, float value, uint8_t flags, uint64_t timestamp_us)
+{
+    if (!records || handle >= record_count)
+        return;
+
+    ShmRecord *r = &records[handle];
+    platform_mutex_lock(&write_lock);
+    uint32_t seq = atomic_load_explicit(&r->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&r->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    r->value        = value;
+    r->flags        = flags;
+    r->timestamp_us = timestamp_us;
+
+    atomic_store_explicit(&r->seq, seq + 2, memory_order_release);
+    platform_mutex_unlock(&write_lock);
+}
+
+void shm_publisher_update_flags(SignalHandle handle, uint8_t flags)
+{
+    if (!records || handle >= record_count)
+        return;
+
+    ShmRecord *r = &records[handle];
+    platform_mutex_lock(&write_lock);
+    uint32_t seq = atomic_load_explicit(&r->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&r->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    r->flags = flags;
+
+    atomic_store_explicit(&r->seq, seq + 2, memory_order_release);
+    platform_mutex_unlock(&write_lock);
+}
+
+void shm_publisher_close(void)
+{
+    if (!segment)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(segment);
+    CloseHandle(mapping);
+    mapping = NULL;
+#else
+    munmap(segment, segment_size);
+    shm_unlink(segment_name);
+#endif
+    segment = NULL;
+    records = NULL;
+    record_count = 0;
+}
@@ -0,0 +1,22 @@
+#ifndef SHM_PUBLISHER_H
+#define SHM_PUBLISHER_H
+
+#include <stdint.h>
+
+#include "signal_registry.h"
+
+/* Create the shared-memory segment (see shm_layout.h) with one record
+ * per registered signal. Returns 0 on success, -1 on failure.
+ */
+int shm_publisher_init(const char *name);
+
+/* Publish the latest value of a signal. No-op if not initialized. */
+void shm_publisher_update(SignalHandle handle, float value, uint8_t flags, uint64_t timestamp_us);
+
+/* Change only the flags of a signal (e.g. staleness), keeping its value. */
+void shm_publisher_update_flags(SignalHandle handle, uint8_t flags);
+
+/* Unmap and remove the segment. */
+void shm_publisher_close(void);
+
+#endif /* SHM_PUBLISHER_H */
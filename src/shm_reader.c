@@ -0,0 +1,173 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "shm_reader.h"
+#include "shm_layout.h"
+
+#ifdef _WIN32
+#include <stdio.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct ShmReader
+{
+    const uint8_t *base;
+    size_t         size;
+    const uint8_t *records;
+    uint32_t       record_size;
+    int            count;
+#ifdef _WIN32
+    HANDLE         mapping;
+#endif
+};
+
+static void unmap(const void *p, size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(p);
+#else
+    munmap((void *)p, size);
+#endif
+}
+
+static ShmRecord *record_at(const ShmReader *reader, int index)
+{
+    return (ShmRecord *)(reader->records + (size_t)index * reader->record_size);
+}
+
+/* PUBLIC API */
+
+ShmReader *shm_reader_open(const char *name)
+{
+    const uint8_t *p;
+    size_t size;
+
+#ifdef _WIN32
+    char local_name[80];
+    snprintf(local_name, sizeof(local_name), "Local\\%s", name[0] == '/' ? name + 1 : name);
+
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, local_name);
+    if (!mapping)
+        return NULL;
+    p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!p) {
+        CloseHandle(mapping);
+        return NULL;
+    }
+    MEMORY_BASIC_INFORMATION mbi;
+    VirtualQuery(p, &mbi, sizeof(mbi));
+    size = mbi.RegionSize;
+#else
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(ShmHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size = (size_t)st.st_size;
+    p = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return NULL;
+#endif
+
+    const ShmHeader *h = (const ShmHeader *)p;
+    uint32_t magic = h->magic;
+    atomic_thread_fence(memory_order_acquire);
+
+    if (magic != SHM_MAGIC || h->version != SHM_LAYOUT_VERSION ||
+        h->record_size < sizeof(ShmRecord) ||
+        h->header_size + (size_t)h->record_count * h->record_size > size) {
+        unmap(p, size);
+#ifdef _WIN32
+        CloseHandle(mapping);
+#endif
+        return NULL;
+    }
+
+    ShmReader *reader = calloc(1, sizeof(*reader));
+    if (!reader) {
+        unmap(p, size);
+#ifdef _WIN32
+        CloseHandle(mapping);
+#endif
+        return NULL;
+    }
+    reader->base        = p;
+    reader->size        = size;
+    reader->records     = p + h->header_size;
+    reader->record_size = h->record_size;
+    reader->count       = (int)h->record_count;
+#ifdef _WIN32
+    reader->mapping     = mapping;
+#endif
+    return reader;
+}
+
+void shm_reader_close(ShmReader *reader)
+{
+    if (!reader)
+        return;
+    unmap(reader->base, reader->size);
+#ifdef _WIN32
+    CloseHandle(reader->mapping);
+#endif
+    free(reader);
+}
+
+int shm_reader_count(const ShmReader *reader)
+{
+    return reader->count;
+}
+
+int shm_reader_find(const ShmReader *reader, const char *name)
+{
+    for (int i = 0; i < reader->count; i++) {
+        if (strncmp(record_at(reader, i)->name, name, sizeof(((ShmRecord *)0)->name)) == 0)
+            return i;
+    }
+    return -1;
+}
+
+const char *shm_reader_name(const ShmReader *reader, int index)
+{
+    return (index >= 0 && index < reader->count) ? record_at(reader, index)->name : NULL;
+}
+
+const char *shm_reader_unit(const ShmReader *reader, int index)
+{
+    return (index >= 0 && index < reader->count) ? record_at(reader, index)->unit : NULL;
+}
+
+int shm_reader_read(const ShmReader *reader, int index, ShmSample *out)
+{
+    if (index < 0 || index >= reader->count)
+        return -1;
+
+    ShmRecord *r = record_at(reader, index);
+    uint32_t before, after;
+
+    do {
+        before = atomic_load_explicit(&r->seq, memory_order_acquire);
+        if (before & 1)
+            continue;
+
+        out->value        = r->value;
+        out->flags        = r->flags;
+        out->timestamp_us = r->timestamp_us;
+
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&r->seq, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    out->version = before;
+    return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef SHM_READER_H
+#define SHM_READER_H
+
+#include <stdint.h>
+
+/* Reader side of the shared-memory state (see shm_layout.h).
+ *
+ * Self-contained: consumers build shm_reader.c with shm_layout.h and
+ * need nothing else from this project. After shm_reader_open() every
+ * read is a plain memory access, no syscalls.
+ */
+
+typedef struct ShmReader ShmReader;
+
+typedef struct
+{
+    float    value;
+    uint8_t  flags;          /* SIGNAL_FLAG_* */
+    uint64_t timestamp_us;   /* 0 until the signal has been decoded once */
+    uint32_t version;        /* Record seq, changes on every update */
+} ShmSample;
+
+/* Map an existing segment read-only. Returns NULL if it does not exist
+ * or has an unknown magic/version.
+ */
+ShmReader *shm_reader_open(const char *name);
+
+void shm_reader_close(ShmReader *reader);
+
+/* Number of signals in the segment. */
+int shm_reader_count(const ShmReader *reader);
+
+/* Record index of a signal by name, or -1. */
+int shm_reader_find(const ShmReader *reader, const char *name);
+
+const char *shm_reader_name(const ShmReader *reader, int index);
+const char *shm_reader_unit(const ShmReader *reader, int index);
+
+/* Copy a consistent sample of one record, retrying while the writer
+ * is mid-update. Returns 0 on success, -1 for a bad index.
+ */
+int shm_reader_read(const ShmReader *reader, int index, ShmSample *out);
+
+#endif /* SHM_READER_H */
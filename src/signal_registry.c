@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "signal_registry.h"
+
+static SignalInfo registry[MAX_SIGNALS];
+static int        registered = 0;
+
+SignalHandle signal_register(const char *name, const char *unit, float min, float max)
+{
+    SignalHandle existing = signal_lookup(name);
+    if (existing != SIGNAL_INVALID)
+        return existing;
+
+    if (registered >= MAX_SIGNALS) {
+        printf("ERROR: Signal registry full, %s not registered\n", name);
+        return SIGNAL_INVALID;
+    }
+
+    SignalInfo *info = &registry[registered];
+
+    snprintf(info->name, sizeof(info->name), "%s", name);
+    snprintf(info->unit, sizeof(info->unit), "%s", unit);
+    info->min = min;
+    info->max = max;
+
+    /* "Motor_RPM" -> key "motor_rpm", label "Motor RPM" */
+    for (size_t i = 0; i < sizeof(info->key) && info->name[i]; i++) {
+        info->key[i]   = (char)tolower((unsigned char)info->name[i]);
+        info->label[i] = (info->name[i] == '_') ? ' ' : info->name[i];
+    }
+
+    return (SignalHandle)registered++;
+}
+
+SignalHandle signal_lookup(const char *name)
+{
+    for (int i = 0; i < registered; i++) {
+        if (strcmp(registry[i].name, name) == 0)
+            return (SignalHandle)i;
+    }
+    return SIGNAL_INVALID;
+}
+
+int signal_count(void)
+{
+    return registered;
+}
+
+const SignalInfo *signal_info(SignalHandle handle)
+{
+    return (handle < registered) ? &registry[handle] : NULL;
+}
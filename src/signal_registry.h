@@ -0,0 +1,41 @@
+#ifndef SIGNAL_REGISTRY_H
+#define SIGNAL_REGISTRY_H
+
+#include <stdint.h>
+
+/* Registry of all known signals.
+ * Signals are registered once at load time and receive dense integer
+ * handles (0, 1, 2, ...). Handles index the value and flag arrays of
+ * the data model and every per-signal table in other modules.
+ */
+
+typedef uint16_t SignalHandle;
+
+#define MAX_SIGNALS     64
+#define SIGNAL_INVALID  ((SignalHandle)0xFFFF)
+
+typedef struct
+{
+    char  name[32];    /* Signal name as defined, e.g. "Motor_RPM" */
+    char  key[32];     /* Lower-case name used as JSON key, e.g. "motor_rpm" */
+    char  label[32];   /* Display label, e.g. "Motor RPM" */
+    char  unit[8];
+    float min;
+    float max;
+} SignalInfo;
+
+/* Register a signal. Returns its handle, the existing handle if the
+ * name is already registered, or SIGNAL_INVALID when the registry is full.
+ */
+SignalHandle signal_register(const char *name, const char *unit, float min, float max);
+
+/* Find a signal by name (load time, not for the hot path). */
+SignalHandle signal_lookup(const char *name);
+
+/* Number of registered signals; valid handles are 0 .. count-1. */
+int signal_count(void);
+
+/* Metadata of a registered signal. */
+const SignalInfo *signal_info(SignalHandle handle);
+
+#endif /* SIGNAL_REGISTRY_H */
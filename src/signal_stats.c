@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "signal_stats.h"
+#include "platform.h"
+
+#define SKETCH_SLOTS (STATS_SKETCH_BINS + 2)   /* Below range, bins, above range */
+
+/* Welford aggregate plus quantile sketch of one window. */
+typedef struct
+{
+    uint64_t count;
+    double   mean;
+    double   m2;                     /* Sum of squared deviations from the mean */
+    float    min;
+    float    max;
+    uint64_t bins[SKETCH_SLOTS];
+} StatsWindow;
+
+typedef struct
+{
+    float       lo;                  /* Sketch range */
+    float       bin_width;
+    StatsWindow total;
+    StatsWindow tumbling;            /* Window in progress */
+    StatsWindow tumbling_done;       /* Last complete window */
+    uint64_t    tumbling_epoch;      /* Window number of tumbling */
+    StatsWindow panes[STATS_PANES];
+    uint64_t    pane_epoch[STATS_PANES];
+} SignalStats;
+
+static SignalStats      stats[MAX_SIGNALS];
+static platform_mutex_t stats_lock;
+
+static uint64_t now_ms(void)
+{
+    return platform_time_us() / 1000;
+}
+
+/* WINDOW AGGREGATES */
+
+static void window_add(StatsWindow *w, const SignalStats *s, float value)
+{
+    double delta = value - w->mean;
+
+    w->count++;
+    w->mean += delta / (double)w->count;
+    w->m2   += delta * (value - w->mean);
+
+    if (w->count == 1 || value < w->min)
+        w->min = value;
+    if (w->count == 1 || value > w->max)
+        w->max = value;
+
+    int slot;
+    if (value < s->lo)
+        slot = 0;
+    else {
+        slot = 1 + (int)((value - s->lo) / s->bin_width);
+        if (slot > SKETCH_SLOTS - 1)
+            slot = SKETCH_SLOTS - 1;
+    }
+    w->bins[slot]++;
+}
+
+/* Combines two aggregates (Chan et al. parallel variance). */
+static void window_merge(StatsWindow *into, const StatsWindow *w)
+{
+    if (w->count == 0)
+        return;
+
+    if (into->count == 0) {
+        *into = *w;
+        return;
+    }
+
+    uint64_t n = into->count + w->count;
+    double delta = w->mean - into->mean;
+
+    into->m2   += w->m2 + delta * delta * (double)into->count * (double)w->count / (double)n;
+    into->mean += delta * (double)w->count / (double)n;
+    into->count = n;
+
+    if (w->min < into->min)
+        into->min = w->min;
+    if (w->max > into->max)
+        into->max = w->max;
+    for (int i = 0; i < SKETCH_SLOTS; i++)
+        into->bins[i] += w->bins[i];
+}
+
+/* Value below which a fraction q of the window lies, interpolated
+ * linearly inside the bin holding that rank.
+ */
+static float window_quantile(const StatsWindow *w, const SignalStats *s, double q)
+{
+    double rank = q * (double)(w->count - 1);
+    uint64_t seen = 0;
+
+    for (int i = 0; i < SKETCH_SLOTS; i++) {
+        if (w->bins[i] == 0 || (double)(seen + w->bins[i]) <= rank) {
+            seen += w->bins[i];
+            continue;
+        }
+
+        float lo, hi;
+        if (i == 0) {
+            lo = w->min;
+            hi = s->lo;
+        }
+        else if (i == SKETCH_SLOTS - 1) {
+            lo = s->lo + STATS_SKETCH_BINS * s->bin_width;
+            hi = w->max;
+        }
+        else {
+            lo = s->lo + (float)(i - 1) * s->bin_width;
+            hi = lo + s->bin_width;
+        }
+
+        /* Observed extremes are exact, so never step outside them. */
+        if (lo < w->min) lo = w->min;
+        if (hi > w->max) hi = w->max;
+
+        double frac = (rank - (double)seen + 0.5) / (double)w->bins[i];
+        if (frac > 1.0)
+            frac = 1.0;
+        return lo + (float)frac * (hi - lo);
+    }
+
+    return w->max;
+}
+
+/* Moves the tumbling window forward to now; the caller holds the lock. */
+static void rotate_tumbling(SignalStats *s, uint64_t now)
+{
+    uint64_t epoch = now / STATS_TUMBLING_MS;
+
+    if (epoch == s->tumbling_epoch)
+        return;
+
+    if (epoch == s->tumbling_epoch + 1)
+        s->tumbling_done = s->tumbling;
+    else
+        memset(&s->tumbling_done, 0, sizeof(s->tumbling_done));
+
+    memset(&s->tumbling, 0, sizeof(s->tumbling));
+    s->tumbling_epoch = epoch;
+}
+
+/* PUBLIC API */
+
+void signal_stats_init(void)
+{
+    uint64_t now = now_ms();
+
+    platform_mutex_init(&stats_lock);
+    memset(stats, 0, sizeof(stats));
+
+    for (int h = 0; h < signal_count(); h++) {
+        const SignalInfo *info = signal_info((SignalHandle)h);
+        float range = info->max - info->min;
+
+        stats[h].lo             = info->min;
+        stats[h].bin_width      = (range > 0.0f ? range : 1.0f) / STATS_SKETCH_BINS;
+        stats[h].tumbling_epoch = now / STATS_TUMBLING_MS;
+    }
+}
+
+void signal_stats_update(SignalHandle handle, float value)
+{
+    if (handle >= MAX_SIGNALS)
+        return;
+
+    SignalStats *s = &stats[handle];
+    uint64_t now = now_ms();
+    uint64_t pane_epoch = now / STATS_PANE_MS;
+    int pane = (int)(pane_epoch % STATS_PANES);
+
+    platform_mutex_lock(&stats_lock);
+
+    rotate_tumbling(s, now);
+    if (s->pane_epoch[pane] != pane_epoch) {
+        memset(&s->panes[pane], 0, sizeof(s->panes[pane]));
+        s->pane_epoch[pane] = pane_epoch;
+    }
+
+    window_add(&s->total, s, value);
+    window_add(&s->tumbling, s, value);
+    window_add(&s->panes[pane], s, value);
+
+    platform_mutex_unlock(&stats_lock);
+}
+
+/* JSON */
+
+static int write_window(char *buf, size_t len, const char *name,
+                        const StatsWindow *w, const SignalStats *s)
+{
+    if (w->count == 0)
+        return snprintf(buf, len, "\"%s\":{\"count\":0}", name);
+
+    double variance = w->count > 1 ? w->m2 / (double)(w->count - 1) : 0.0;
+
+    return snprintf(buf, len,
+                    "\"%s\":{\"count\":%llu,\"min\":%.3f,\"max\":%.3f,\"mean\":%.3f,"
+                    "\"variance\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f}",
+                    name, (unsigned long long)w->count, w->min, w->max, w->mean,
+                    variance,
+                    window_quantile(w, s, 0.50),
+                    window_quantile(w, s, 0.90),
+                    window_quantile(w, s, 0.99));
+}
+
+int signal_stats_write_json(char *buf, size_t len)
+{
+    uint64_t now = now_ms();
+    uint64_t pane_epoch = now / STATS_PANE_MS;
+
+    int off = snprintf(buf, len,
+                       "{\"tumbling_ms\":%d,\"sliding_ms\":%d,\"signals\":{",
+                       STATS_TUMBLING_MS, STATS_SLIDING_MS);
+
+    platform_mutex_lock(&stats_lock);
+
+    for (int h = 0; h < signal_count() && off > 0 && (size_t)off < len; h++) {
+        SignalStats *s = &stats[h];
+        const SignalInfo *info = signal_info((SignalHandle)h);
+        StatsWindow sliding;
+
+        rotate_tumbling(s, now);
+
+        memset(&sliding, 0, sizeof(sliding));
+        for (int p = 0; p < STATS_PANES; p++) {
+            if (s->pane_epoch[p] + STATS_PANES > pane_epoch)
+                window_merge(&sliding, &s->panes[p]);
+        }
+
+        off += snprintf(buf + off, len - off, "%s\"%s\":{\"unit\":\"%s\",",
+                        h ? "," : "", info->key, info->unit);
+        if (off > 0 && (size_t)off < len)
+            off += write_window(buf + off, len - off, "total", &s->total, s);
+        if (off > 0 && (size_t)off < len)
+            off += snprintf(buf + off, len - off, ",");
+        if (off > 0 && (size_t)off < len)
+            off += write_window(buf + off, len - off, "tumbling", &s->tumbling_done, s);
+        if (off > 0 && (size_t)off < len)
+            off += snprintf(buf + off, len - off, ",");
+        if (off > 0 && (size_t)off < len)
+            off += write_window(buf + off, len - off, "sliding", &sliding, s);
+        if (off > 0 && (size_t)off < len)
+            off += snprintf(buf + off, len - off, "}");
+    }
+
+    platform_mutex_unlock(&stats_lock);
+
+    if (off > 0 && (size_t)off < len)
+        off += snprintf(buf + off, len - off, "}}");
+
+    return (off > 0 && (size_t)off < len) ? off : (int)(len ? len - 1 : 0);
+}
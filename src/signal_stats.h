@@ -0,0 +1,41 @@
+#ifndef SIGNAL_STATS_H
+#define SIGNAL_STATS_H
+
+#include <stddef.h>
+
+#include "signal_registry.h"
+
+/* Streaming statistics of every decoded signal, kept without storing
+ * raw samples.
+ *
+ * For each signal and window: count, min, max, mean and sample variance
+ * (Welford), and approximate quantiles from a fixed-size histogram over
+ * the signal's min..max range (one bin on either side for values outside
+ * it). Quantile error is at most one bin width, range / STATS_SKETCH_BINS.
+ *
+ *   total     since start-up
+ *   tumbling  the last complete STATS_TUMBLING_MS window
+ *   sliding   the last STATS_SLIDING_MS, made of STATS_PANES panes that
+ *             expire one at a time, merged when read
+ */
+
+#define STATS_SKETCH_BINS   32
+#define STATS_TUMBLING_MS   10000
+#define STATS_PANES         12
+#define STATS_PANE_MS       5000
+#define STATS_SLIDING_MS    (STATS_PANES * STATS_PANE_MS)
+
+/* Size the quantile sketches from the signal registry. Call after all
+ * signals are registered.
+ */
+void signal_stats_init(void);
+
+/* Add one decoded value. Thread-safe. */
+void signal_stats_update(SignalHandle handle, float value);
+
+/* Writes the statistics of all signals as JSON, keyed like /data.
+ * Returns bytes written.
+ */
+int signal_stats_write_json(char *buf, size_t len);
+
+#endif /* SIGNAL_STATS_H */
@@ -0,0 +1,362 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "static_files.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#endif
+
+/* CACHE CONFIGURATION */
+
+#define STATIC_CACHE_SIZE   32          /* Number of cached assets */
+#define STATIC_PATH_MAX     256
+#define STATIC_MEMORY_MAX   (64 * 1024) /* Larger files are sent with sendfile() */
+#define STATIC_RECHECK_SEC  1           /* How often a cached file is re-stat()ed */
+
+/* One encoding of an asset (identity or precompressed .gz). */
+typedef struct
+{
+    int    present;
+    size_t size;
+    time_t mtime;
+    char   etag[48];
+    char  *data;        /* Contents, when small enough to keep in memory */
+#ifndef _WIN32
+    int    fd;          /* Open descriptor for sendfile(), otherwise -1 */
+#endif
+} StaticVariant;
+
+typedef struct
+{
+    char          path[STATIC_PATH_MAX]; /* Request path, empty if slot unused */
+    time_t        checked;               /* Last time the files were stat()ed */
+    StaticVariant plain;
+    StaticVariant gzip;
+} StaticEntry;
+
+static char        web_root[STATIC_PATH_MAX] = ".";
+static StaticEntry cache[STATIC_CACHE_SIZE];
+static int         next_victim = 0;
+
+/* MIME TYPES (also acts as the whitelist of servable extensions) */
+
+static const struct { const char *ext; const char *type; } mime_types[] =
+{
+    { ".html", "text/html; charset=utf-8" },
+    { ".htm",  "text/html; charset=utf-8" },
+    { ".css",  "text/css" },
+    { ".js",   "application/javascript" },
+    { ".json", "application/json" },
+    { ".svg",  "image/svg+xml" },
+    { ".png",  "image/png" },
+    { ".ico",  "image/x-icon" }
+};
+
+static const char *lookup_mime(const char *path)
+{
+    const char *ext = strrchr(path, '.');
+    if (!ext)
+        return NULL;
+
+    for (size_t i = 0; i < sizeof(mime_types) / sizeof(mime_types[0]); i++) {
+        if (strcmp(ext, mime_types[i].ext) == 0)
+            return mime_types[i].type;
+    }
+    return NULL;
+}
+
+/* Rejects traversal, dotfiles and backslashes. */
+static int is_safe_path(const char *path)
+{
+    if (path[0] != '/')
+        return 0;
+    if (strstr(path, "..") || strstr(path, "/.") || strchr(path, '\\'))
+        return 0;
+    return 1;
+}
+
+/* VARIANT LOADING */
+
+static void variant_release(StaticVariant *v)
+{
+    free(v->data);
+    v->data = NULL;
+#ifndef _WIN32
+    if (v->present && v->fd >= 0)
+        close(v->fd);
+    v->fd = -1;
+#endif
+    v->present = 0;
+}
+
+static char *read_whole_file(const char *fs_path, size_t size)
+{
+    FILE *f = fopen(fs_path, "rb");
+    if (!f)
+        return NULL;
+
+    char *buf = malloc(size ? size : 1);
+    if (buf && fread(buf, 1, size, f) != size) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    return buf;
+}
+
+/* Refresh a variant from disk if it appeared, vanished or changed. */
+static void variant_refresh(StaticVariant *v, const char *fs_path, int is_gzip)
+{
+    struct stat st;
+
+    if (stat(fs_path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        variant_release(v);
+        return;
+    }
+
+    if (v->present && v->size == (size_t)st.st_size && v->mtime == st.st_mtime)
+        return;
+
+    variant_release(v);
+
+    v->size  = (size_t)st.st_size;
+    v->mtime = st.st_mtime;
+
+#ifdef _WIN32
+    v->data = read_whole_file(fs_path, v->size);
+    if (!v->data)
+        return;
+#else
+    if (v->size <= STATIC_MEMORY_MAX) {
+        v->data = read_whole_file(fs_path, v->size);
+        if (!v->data)
+            return;
+    } else {
+        v->fd = open(fs_path, O_RDONLY);
+        if (v->fd < 0)
+            return;
+    }
+#endif
+
+    snprintf(v->etag, sizeof(v->etag), "\"%lx-%lx%s\"",
+             (unsigned long)v->mtime, (unsigned long)v->size,
+             is_gzip ? "-gz" : "");
+    v->present = 1;
+}
+
+static StaticEntry *cache_lookup(const char *path)
+{
+    StaticEntry *e = NULL;
+    char fs_path[2 * STATIC_PATH_MAX];
+    struct stat st;
+
+    for (int i = 0; i < STATIC_CACHE_SIZE; i++) {
+        if (strcmp(cache[i].path, path) == 0) {
+            e = &cache[i];
+            break;
+        }
+    }
+
+    if (!e) {
+        /* Missing files never take a slot, so they cannot flush the cache. */
+        snprintf(fs_path, sizeof(fs_path), "%s%s", web_root, path);
+        if (stat(fs_path, &st) != 0 || !S_ISREG(st.st_mode))
+            return NULL;
+
+        /* Round-robin eviction keeps the cache bounded without bookkeeping. */
+        e = &cache[next_victim];
+        next_victim = (next_victim + 1) % STATIC_CACHE_SIZE;
+
+        variant_release(&e->plain);
+        variant_release(&e->gzip);
+        snprintf(e->path, sizeof(e->path), "%s", path);
+        e->checked = 0;
+    }
+
+    time_t now = time(NULL);
+    if (now - e->checked >= STATIC_RECHECK_SEC) {
+        snprintf(fs_path, sizeof(fs_path), "%s%s", web_root, path);
+        variant_refresh(&e->plain, fs_path, 0);
+
+        snprintf(fs_path, sizeof(fs_path), "%s%s.gz", web_root, path);
+        variant_refresh(&e->gzip, fs_path, 1);
+
+        e->checked = now;
+    }
+
+    return e;
+}
+
+/* SENDING */
+
+static int send_all(int client, const char *buf, size_t len)
+{
+    while (len > 0) {
+        int n = send(client, buf, (int)len, 0);
+        if (n <= 0)
+            return -1;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int send_body(int client, const char *hdr, size_t hdr_len, const StaticVariant *v)
+{
+#ifdef _WIN32
+    if (send_all(client, hdr, hdr_len) < 0)
+        return -1;
+    return send_all(client, v->data, v->size);
+#else
+    if (v->data) {
+        /* Header and body leave in a single syscall. */
+        struct iovec iov[2] = {
+            { (void *)hdr,     hdr_len },
+            { (void *)v->data, v->size }
+        };
+        ssize_t n = writev(client, iov, 2);
+        if (n < 0)
+            return -1;
+        if ((size_t)n < hdr_len)
+            return send_all(client, hdr + n, hdr_len - (size_t)n) < 0 ? -1 :
+                   send_all(client, v->data, v->size);
+        n -= (ssize_t)hdr_len;
+        return send_all(client, v->data + n, v->size - (size_t)n);
+    }
+
+    if (send_all(client, hdr, hdr_len) < 0)
+        return -1;
+
+    off_t off = 0;
+#ifdef __linux__
+    /* Zero-copy from the page cache straight into the socket. */
+    while ((size_t)off < v->size) {
+        ssize_t n = sendfile(client, v->fd, &off, v->size - (size_t)off);
+        if (n <= 0)
+            return -1;
+    }
+#else
+    char chunk[16384];
+    while ((size_t)off < v->size) {
+        ssize_t n = pread(v->fd, chunk, sizeof(chunk), off);
+        if (n <= 0 || send_all(client, chunk, (size_t)n) < 0)
+            return -1;
+        off += n;
+    }
+#endif
+    return 0;
+#endif
+}
+
+static int accepts_gzip(const char *accept_encoding)
+{
+    if (!accept_encoding)
+        return 0;
+
+    /* Comma-separated codings, each optionally followed by ";q=<weight>" */
+    const char *p = accept_encoding;
+    while (p) {
+        p += strspn(p, " \t,");
+        const char *next = strchr(p, ',');
+
+        if (strncmp(p, "gzip", 4) == 0 && strchr(" \t;,", p[4])) {
+            double q = 1.0;
+            const char *param = p + 4 + strspn(p + 4, " \t");
+
+            if (*param == ';') {
+                param++;
+                param += strspn(param, " \t");
+                if (*param == 'q' || *param == 'Q') {
+                    param++;
+                    param += strspn(param, " \t");
+                    if (*param == '=')
+                        q = strtod(param + 1, NULL);
+                }
+            }
+
+            /* A weight of 0 explicitly refuses the encoding. */
+            return q > 0.0;
+        }
+
+        p = next;
+    }
+    return 0;
+}
+
+/* PUBLIC API */
+
+void static_files_init(const char *root)
+{
+    if (root && root[0])
+        snprintf(web_root, sizeof(web_root), "%s", root);
+}
+
+int static_files_serve(int client,
+                       const char *path,
+                       const char *accept_encoding,
+                       const char *if_none_match)
+{
+    if (strcmp(path, "/") == 0)
+        path = "/index.html";
+
+    const char *mime = lookup_mime(path);
+    if (!mime || !is_safe_path(path) || strlen(path) >= STATIC_PATH_MAX)
+        return -1;
+
+    StaticEntry *e = cache_lookup(path);
+    if (!e || !e->plain.present)
+        return -1;
+
+    const StaticVariant *v = &e->plain;
+    int use_gzip = e->gzip.present && accepts_gzip(accept_encoding);
+    if (use_gzip)
+        v = &e->gzip;
+
+    /* Pages are revalidated every load, other assets may be cached outright. */
+    const char *cache_control = strncmp(mime, "text/html", 9) == 0
+                              ? "no-cache"
+                              : "public, max-age=3600";
+
+    char hdr[512];
+    int  hdr_len;
+
+    if (if_none_match && (strstr(if_none_match, v->etag) || if_none_match[0] == '*')) {
+        hdr_len = snprintf(hdr, sizeof(hdr),
+            "HTTP/1.1 304 Not Modified\r\n"
+            "ETag: %s\r\n"
+            "Cache-Control: %s\r\n"
+            "%s"
+            "Connection: close\r\n\r\n",
+            v->etag, cache_control,
+            e->gzip.present ? "Vary: Accept-Encoding\r\n" : "");
+        send_all(client, hdr, (size_t)hdr_len);
+        return 0;
+    }
+
+    hdr_len = snprintf(hdr, sizeof(hdr),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %lu\r\n"
+        "ETag: %s\r\n"
+        "Cache-Control: %s\r\n"
+        "%s%s"
+        "Connection: close\r\n\r\n",
+        mime, (unsigned long)v->size, v->etag, cache_control,
+        e->gzip.present ? "Vary: Accept-Encoding\r\n" : "",
+        use_gzip ? "Content-Encoding: gzip\r\n" : "");
+
+    send_body(client, hdr, (size_t)hdr_len, v);
+    return 0;
+}
@@ -0,0 +1,17 @@
+#ifndef STATIC_FILES_H
+#define STATIC_FILES_H
+
+/* Set the directory static assets are served from. */
+void static_files_init(const char *root);
+
+/* Serve a static asset on an accepted client socket.
+ * path is the request path ("/" maps to /index.html), accept_encoding and
+ * if_none_match are the raw request header values or NULL.
+ * Returns 0 when a response was sent, -1 when no such asset exists.
+ */
+int static_files_serve(int client,
+                       const char *path,
+                       const char *accept_encoding,
+                       const char *if_none_match);
+
+#endif /* STATIC_FILES_H */
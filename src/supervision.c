@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "supervision.h"
+#include "timer_wheel.h"
+#include "platform.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#define SLEEP_MS(ms) Sleep(ms)
+#else
+#include <unistd.h>
+#define SLEEP_MS(ms) usleep((ms) * 1000)
+#endif
+
+#define SUPERVISION_MAX_IDS 0x800
+
+typedef struct
+{
+    TimerNode   timer;         /* First member: the timer maps back to its entry */
+    const char *name;
+    uint32_t    cycle_ms;
+    uint64_t    last_seen_ms;
+    uint64_t    timeouts;
+    int         supervised;
+    int         stale;
+} SupervisedMessage;
+
+/* SUPERVISION STATE */
+
+static SupervisedMessage      messages[SUPERVISION_MAX_IDS];
+static TimerWheel             wheel;
+static platform_mutex_t       lock;
+static supervision_change_fn  change_fn = NULL;
+static platform_thread_t      thread;
+
+static uint64_t now_ms(void)
+{
+    return platform_time_us() / 1000u;
+}
+
+static uint64_t timeout_ms(const SupervisedMessage *m)
+{
+    return (uint64_t)m->cycle_ms * SUPERVISION_TIMEOUT_FACTOR;
+}
+
+static void on_expired(TimerNode *node, void *ctx)
+{
+    (void)ctx;
+    SupervisedMessage *m = (SupervisedMessage *)node;
+
+    m->stale = 1;
+    m->timeouts++;
+    if (change_fn)
+        change_fn((uint16_t)(m - messages), 1);
+}
+
+static void *supervision_thread(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        platform_mutex_lock(&lock);
+        timer_wheel_advance(&wheel, now_ms(), on_expired, NULL);
+        platform_mutex_unlock(&lock);
+
+        SLEEP_MS(SUPERVISION_TICK_MS);
+    }
+
+    return NULL;
+}
+
+/* PUBLIC API */
+
+void supervision_init(supervision_change_fn on_change)
+{
+    memset(messages, 0, sizeof(messages));
+    timer_wheel_init(&wheel, now_ms());
+    platform_mutex_init(&lock);
+    change_fn = on_change;
+}
+
+void supervision_add(uint16_t can_id, const char *message_name, uint32_t cycle_ms)
+{
+    if (can_id >= SUPERVISION_MAX_IDS || cycle_ms == 0)
+        return;
+
+    SupervisedMessage *m = &messages[can_id];
+
+    platform_mutex_lock(&lock);
+    m->name       = message_name;
+    m->cycle_ms   = cycle_ms;
+    m->supervised = 1;
+    timer_wheel_schedule(&wheel, &m->timer, wheel.now + timeout_ms(m));
+    platform_mutex_unlock(&lock);
+}
+
+void supervision_frame_seen(uint16_t can_id)
+{
+    if (can_id >= SUPERVISION_MAX_IDS || !messages[can_id].supervised)
+        return;
+
+    SupervisedMessage *m = &messages[can_id];
+    uint64_t now = now_ms();
+
+    platform_mutex_lock(&lock);
+    m->last_seen_ms = now;
+    timer_wheel_schedule(&wheel, &m->timer, now + timeout_ms(m));
+
+    if (m->stale) {
+        m->stale = 0;
+        if (change_fn)
+            change_fn(can_id, 0);
+    }
+    platform_mutex_unlock(&lock);
+}
+
+int supervision_start(void)
+{
+    if (platform_thread_start(&thread, supervision_thread, NULL) < 0) {
+        printf("ERROR: Cannot start supervision thread\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* METRICS */
+
+int supervision_write_metrics(char *buf, size_t len)
+{
+    uint64_t now = now_ms();
+    int off = snprintf(buf, len,
+                       "# TYPE can_msg_stale gauge\n"
+                       "# TYPE can_msg_timeouts_total counter\n"
+                       "# TYPE can_msg_age_ms gauge\n");
+
+    platform_mutex_lock(&lock);
+    for (int id = 0; id < SUPERVISION_MAX_IDS && off > 0 && (size_t)off < len; id++) {
+        const SupervisedMessage *m = &messages[id];
+        if (!m->supervised)
+            continue;
+
+        off += snprintf(buf + off, len - off,
+                        "can_msg_stale{id=\"0x%03X\",message=\"%s\"} %d\n"
+                        "can_msg_timeouts_total{id=\"0x%03X\",message=\"%s\"} %llu\n",
+                        id, m->name, m->stale,
+                        id, m->name, (unsigned long long)m->timeouts);
+
+        if (m->last_seen_ms && off > 0 && (size_t)off < len) {
+            off += snprintf(buf + off, len - off,
+                            "can_msg_age_ms{id=\"0x%03X\",message=\"%s\"} %llu\n",
+                            id, m->name, (unsigned long long)(now - m->last_seen_ms));
+        }
+    }
+    platform_mutex_unlock(&lock);
+
+    return (off > 0 && (size_t)off < len) ? off : (int)(len ? len - 1 : 0);
+}
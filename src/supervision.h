@@ -0,0 +1,42 @@
+#ifndef SUPERVISION_H
+#define SUPERVISION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Reception supervision of cyclic messages.
+ *
+ * Every supervised CAN ID has an expected cycle time (GenMsgCycleTime in
+ * DBC terms). If no frame arrives within SUPERVISION_TIMEOUT_FACTOR
+ * cycles, the message is reported stale until the next frame. Deadlines
+ * live in a timer wheel (1 ms ticks), so a received frame costs O(1)
+ * however many IDs are supervised.
+ */
+
+#define SUPERVISION_TIMEOUT_FACTOR  3
+#define SUPERVISION_TICK_MS         10    /* Resolution of the supervision thread */
+
+/* Called when a message becomes stale (stale = 1) or is received again
+ * (stale = 0). Runs on the supervision or decode thread.
+ */
+typedef void (*supervision_change_fn)(uint16_t can_id, int stale);
+
+void supervision_init(supervision_change_fn on_change);
+
+/* Supervise can_id with the given cycle time. The first deadline runs
+ * from now, so a message that never arrives also becomes stale.
+ */
+void supervision_add(uint16_t can_id, const char *message_name, uint32_t cycle_ms);
+
+/* Record the reception of a frame. */
+void supervision_frame_seen(uint16_t can_id);
+
+/* Start the thread that expires deadlines. Returns 0 on success. */
+int supervision_start(void);
+
+/* Writes per-message stale state, timeout count and age of the last
+ * frame in Prometheus text format. Returns bytes written.
+ */
+int supervision_write_metrics(char *buf, size_t len);
+
+#endif /* SUPERVISION_H */
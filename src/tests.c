@@ -5,6 +5,10 @@
 #include "parser.h"
 #include "can_message.h"
 #include "data_model.h"
+#include "signal_registry.h"
+#include "e2e.h"
+#include "decoder_fuzz.h"
+#include "platform.h"
 
 static void add_test_result(const char *name, const char *input, const char *output, TestStatus status)
 {
@@ -34,7 +38,7 @@ static void test_motor_rpm_parsing(void)
 
     parse_can_message(&msg);
 
-    if ((int)g_vehicle_data.motor_rpm == 5000) {
+    if ((int)g_vehicle_data.values[signal_lookup("Motor_RPM")] == 5000) {
         add_test_result(
             "Motor RPM Parsing",
             "ID=0x101 DLC=2 DATA=[13 88]",
@@ -64,7 +68,7 @@ static void test_voltage_scaling(void)
 
     parse_can_message(&msg);
 
-    if ((int)(g_vehicle_data.battery_voltage * 10) == 625) {
+    if ((int)(g_vehicle_data.values[signal_lookup("Battery_Voltage")] * 10) == 625) {
         add_test_result(
             "Battery Voltage Scaling",
             "ID=0x104 DLC=2 DATA=[02 71]",
@@ -94,7 +98,7 @@ static void test_soc_range_check(void)
 
     parse_can_message(&msg);
 
-    if (g_vehicle_data.battery_soc > 100) {
+    if (g_vehicle_data.values[signal_lookup("Battery_SOC")] > 100) {
         add_test_result(
             "Battery SOC Range Check",
             "ID=0x103 DLC=1 DATA=[FF]",
@@ -177,6 +181,69 @@ static void test_wrong_dlc(void)
 }
 
 
+/* ------------------------------------------------------------
+ * TEST 5: E2E PROTECTION (Inverter status CRC)
+ * ------------------------------------------------------------ */
+static void test_e2e_crc(void)
+{
+    CAN_Message msg = {
+        .id  = 0x110,
+        .dlc = 4,
+        .data = {0x27, 0x74}   /* 10100 -> 10 Nm */
+    };
+
+    e2e_protect(parser_e2e_config(msg.id), &msg, 0);
+    msg.data[1] ^= 0x01;       /* Corrupted after the CRC was computed */
+
+    VehicleData before = g_vehicle_data;
+
+    parse_can_message(&msg);
+
+    if (memcmp(&before, &g_vehicle_data, sizeof(VehicleData)) == 0) {
+        add_test_result(
+            "E2E CRC Check",
+            "ID=0x110 DLC=4 DATA=[27 75 ..] bad CRC",
+            "Corrupted frame rejected",
+            TEST_PASS
+        );
+    } else {
+        add_test_result(
+            "E2E CRC Check",
+            "ID=0x110 DLC=4 DATA=[27 75 ..] bad CRC",
+            "Corrupted frame modified vehicle data",
+            TEST_ERROR
+        );
+    }
+}
+
+
+/* ------------------------------------------------------------
+ * TEST 6: DECODER VS BIT-BY-BIT REFERENCE (random layouts)
+ * ------------------------------------------------------------ */
+static void test_decoder_differential(void)
+{
+    DecoderFuzzOptions opts = { 100000, 0, (uint32_t)platform_wall_time_us() };
+    DecoderFuzzResult result;
+    char input[64], output[64];
+
+    int rc = decoder_fuzz_run(&opts, &result);
+    decoder_fuzz_print(&result);
+
+    snprintf(input, sizeof(input), "%llu random signals, seed %lu",
+             (unsigned long long)result.cases, (unsigned long)opts.seed);
+
+    if (rc == 0) {
+        snprintf(output, sizeof(output), "All match, %.1f M signals/s per thread",
+                 result.decode_s > 0.0 ? (double)result.cases / result.decode_s / 1e6 : 0.0);
+        add_test_result("Decoder Differential", input, output, TEST_PASS);
+    } else {
+        snprintf(output, sizeof(output), "%llu mismatch(es)",
+                 (unsigned long long)result.mismatches);
+        add_test_result("Decoder Differential", input, output, TEST_ERROR);
+    }
+}
+
+
 /* ------------------------------------------------------------
  * TEST RUNNER
  * ------------------------------------------------------------ */
@@ -191,6 +258,8 @@ void run_all_tests(void)
     test_soc_range_check();
     test_unknown_can_id();
     test_wrong_dlc();
+    test_e2e_crc();
+    test_decoder_differential();
 
     printf("All tests executed.\n");
 }
@@ -0,0 +1,115 @@
+#include <stddef.h>
+
+#include "timer_wheel.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+/* Ticks covered by levels 0..level */
+#define LEVEL_SPAN(level) ((uint64_t)1 << (TIMER_WHEEL_BITS * ((level) + 1)))
+
+static void list_init(TimerNode *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+static void list_append(TimerNode *head, TimerNode *node)
+{
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static void insert(TimerWheel *wheel, TimerNode *node)
+{
+    uint64_t delta = node->expires - wheel->now;
+    int level = 0;
+
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= LEVEL_SPAN(level))
+        level++;
+
+    if (delta >= LEVEL_SPAN(level)) {
+        node->expires = wheel->now + LEVEL_SPAN(level) - 1;
+    }
+
+    int slot = (int)((node->expires >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK);
+    list_append(&wheel->slots[level][slot], node);
+}
+
+/* Re-file every timer of one slot relative to the current tick. */
+static void cascade(TimerWheel *wheel, int level, int slot)
+{
+    TimerNode pending;
+    TimerNode *head = &wheel->slots[level][slot];
+
+    if (head->next == head)
+        return;
+
+    /* Detach the slot first: re-filed timers never land in it again. */
+    pending.next = head->next;
+    pending.prev = head->prev;
+    pending.next->prev = &pending;
+    pending.prev->next = &pending;
+    list_init(head);
+
+    while (pending.next != &pending) {
+        TimerNode *node = pending.next;
+        timer_wheel_cancel(node);
+        insert(wheel, node);
+    }
+}
+
+/* PUBLIC API */
+
+void timer_wheel_init(TimerWheel *wheel, uint64_t now)
+{
+    for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        for (int s = 0; s < TIMER_WHEEL_SLOTS; s++)
+            list_init(&wheel->slots[l][s]);
+    }
+    wheel->now = now;
+}
+
+void timer_wheel_schedule(TimerWheel *wheel, TimerNode *node, uint64_t expires)
+{
+    timer_wheel_cancel(node);
+    node->expires = expires > wheel->now ? expires : wheel->now + 1;
+    insert(wheel, node);
+}
+
+void timer_wheel_cancel(TimerNode *node)
+{
+    if (!node->next)
+        return;
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+int timer_wheel_pending(const TimerNode *node)
+{
+    return node->next != NULL;
+}
+
+void timer_wheel_advance(TimerWheel *wheel, uint64_t now, timer_expired_fn fn, void *ctx)
+{
+    while (wheel->now < now) {
+        uint64_t tick = ++wheel->now;
+
+        /* Crossing a level boundary pulls the next slot of that level down. */
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if (tick & (LEVEL_SPAN(level - 1) - 1))
+                break;
+            cascade(wheel, level, (int)((tick >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK));
+        }
+
+        TimerNode *head = &wheel->slots[0][tick & SLOT_MASK];
+        while (head->next != head) {
+            TimerNode *node = head->next;
+            timer_wheel_cancel(node);
+            fn(node, ctx);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+/* Hierarchical timer wheel with O(1) schedule and cancel.
+ *
+ * TIMER_WHEEL_LEVELS wheels of TIMER_WHEEL_SLOTS slots each; level L
+ * slots span 64^L ticks, so four levels cover 64^4 ticks (4.6 hours at
+ * 1 ms per tick). A timer is filed at the coarsest level it needs and
+ * cascades down as its deadline approaches. Later deadlines are clamped
+ * to the wheel's range.
+ *
+ * Timers are intrusive: embed a TimerNode in the supervised object.
+ * Not thread-safe; callers serialize access.
+ */
+
+#define TIMER_WHEEL_BITS    6
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS  4
+
+typedef struct TimerNode
+{
+    struct TimerNode *next;
+    struct TimerNode *prev;
+    uint64_t          expires;   /* Tick at which the timer fires */
+} TimerNode;
+
+typedef struct
+{
+    TimerNode slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];  /* List heads */
+    uint64_t  now;                                           /* Last processed tick */
+} TimerWheel;
+
+typedef void (*timer_expired_fn)(TimerNode *node, void *ctx);
+
+void timer_wheel_init(TimerWheel *wheel, uint64_t now);
+
+/* Make node fire at tick expires (at the next tick if already due),
+ * replacing any earlier schedule of the same node.
+ */
+void timer_wheel_schedule(TimerWheel *wheel, TimerNode *node, uint64_t expires);
+
+void timer_wheel_cancel(TimerNode *node);
+
+int timer_wheel_pending(const TimerNode *node);
+
+/* Process all ticks up to now, calling fn for every timer that expires.
+ * fn may reschedule the node.
+ */
+void timer_wheel_advance(TimerWheel *wheel, uint64_t now, timer_expired_fn fn, void *ctx);
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,579 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "transport.h"
+#include "timer_wheel.h"
+#include "platform.h"
+
+#define CAN_STD_ID_COUNT  0x800
+#define HASH_BITS         6
+#define HASH_SIZE         (1 << HASH_BITS)
+
+/* Session keys: protocol in the top byte, then CAN ID or SA/DA. */
+#define KEY_ISOTP(id)        ((1u << 24) | (id))
+#define KEY_J1939(sa, da)    ((2u << 24) | ((uint32_t)(sa) << 8) | (da))
+
+/* ISO-TP protocol control information (high nibble of byte 0) */
+#define ISOTP_SINGLE       0x0
+#define ISOTP_FIRST        0x1
+#define ISOTP_CONSECUTIVE  0x2
+#define ISOTP_FLOW_CONTROL 0x3
+
+/* J1939 TP.CM control bytes */
+#define TP_CM_RTS    16
+#define TP_CM_CTS    17
+#define TP_CM_EOMA   19
+#define TP_CM_BAM    32
+#define TP_CM_ABORT  255
+
+#define J1939_DT_BYTES     7
+#define J1939_MAX_PAYLOAD  (255 * J1939_DT_BYTES)
+
+typedef enum
+{
+    ERR_SEQUENCE,
+    ERR_TIMEOUT,
+    ERR_OVERFLOW,
+    ERR_NO_BUFFER,
+    ERR_ABORTED,
+    ERR_COUNT
+} TransportError;
+
+static const char *error_names[ERR_COUNT] = {
+    "sequence", "timeout", "overflow", "no_buffer", "aborted"
+};
+
+typedef struct
+{
+    TimerNode         timer;        /* First member: the wheel hands back this node */
+    uint32_t          key;
+    TransportProtocol protocol;
+    uint32_t          id;           /* CAN ID or PGN */
+    uint8_t           source;
+    uint8_t           priority;
+    uint8_t           next_seq;
+    uint8_t           packets;      /* J1939: TP.DT packets of the transfer */
+    uint16_t          expected;
+    uint16_t          received;
+    uint32_t          timeout_ms;
+    int8_t            next;         /* Hash chain or free list, -1 terminates */
+} TransportSession;
+
+/* TRANSPORT STATE */
+
+static TransportSession sessions[TRANSPORT_MAX_SESSIONS];
+static uint8_t          buffers[TRANSPORT_MAX_SESSIONS][TRANSPORT_MAX_PAYLOAD];
+static int8_t           buckets[HASH_SIZE];
+static int8_t           free_list;
+static TimerWheel       timeouts;
+
+static uint8_t isotp_ids[CAN_STD_ID_COUNT / 8];
+
+static int      active;
+static int      high_watermark;
+static uint64_t payloads[2];
+static uint64_t errors[ERR_COUNT];
+
+/* J1939 IDENTIFIERS */
+
+uint32_t j1939_pgn(uint32_t id)
+{
+    uint32_t pgn = (id >> 8) & 0x3FFFF;
+    if (((pgn >> 8) & 0xFF) < 240)
+        pgn &= 0x3FF00;
+    return pgn;
+}
+
+uint8_t j1939_source(uint32_t id)
+{
+    return (uint8_t)(id & 0xFF);
+}
+
+uint32_t j1939_id(uint8_t priority, uint32_t pgn, uint8_t dest, uint8_t source)
+{
+    if (((pgn >> 8) & 0xFF) < 240)
+        pgn = (pgn & 0x3FF00) | dest;
+    return CAN_EFF_FLAG | ((uint32_t)(priority & 7) << 26) | (pgn << 8) | source;
+}
+
+/* SESSION POOL */
+
+static uint64_t now_ms(void)
+{
+    return platform_time_us() / 1000;
+}
+
+static int bucket_of(uint32_t key)
+{
+    return (int)((key * 2654435761u) >> (32 - HASH_BITS));
+}
+
+static TransportSession *session_find(uint32_t key)
+{
+    for (int i = buckets[bucket_of(key)]; i >= 0; i = sessions[i].next) {
+        if (sessions[i].key == key)
+            return &sessions[i];
+    }
+    return NULL;
+}
+
+static void session_release(TransportSession *s)
+{
+    int index = (int)(s - sessions);
+    int8_t *link = &buckets[bucket_of(s->key)];
+
+    while (*link != index)
+        link = &sessions[*link].next;
+    *link = s->next;
+
+    timer_wheel_cancel(&s->timer);
+    s->next = free_list;
+    free_list = (int8_t)index;
+    active--;
+}
+
+/* Start a session for key, replacing a transfer still in progress. */
+static TransportSession *session_open(uint32_t key, uint32_t timeout_ms)
+{
+    TransportSession *s = session_find(key);
+    if (s) {
+        errors[ERR_ABORTED]++;
+        session_release(s);
+    }
+
+    if (free_list < 0) {
+        errors[ERR_NO_BUFFER]++;
+        return NULL;
+    }
+
+    int index = free_list;
+    s = &sessions[index];
+    free_list = s->next;
+
+    memset(s, 0, sizeof(*s));
+    s->key        = key;
+    s->timeout_ms = timeout_ms;
+    s->next       = buckets[bucket_of(key)];
+    buckets[bucket_of(key)] = (int8_t)index;
+
+    if (++active > high_watermark)
+        high_watermark = active;
+
+    timer_wheel_schedule(&timeouts, &s->timer, now_ms() + timeout_ms);
+    return s;
+}
+
+static void session_touch(TransportSession *s)
+{
+    timer_wheel_schedule(&timeouts, &s->timer, now_ms() + s->timeout_ms);
+}
+
+static void on_timeout(TimerNode *node, void *ctx)
+{
+    (void)ctx;
+    errors[ERR_TIMEOUT]++;
+    session_release((TransportSession *)node);
+}
+
+static void session_fail(TransportSession *s, TransportError reason)
+{
+    errors[reason]++;
+    session_release(s);
+}
+
+/* Hands the finished payload of s to the caller and frees the session;
+ * its buffer stays intact until the session slot is reused.
+ */
+static TransportResult session_complete(TransportSession *s, const CAN_Message *msg,
+                                        TransportPayload *out)
+{
+    out->protocol     = s->protocol;
+    out->id           = s->id;
+    out->source       = s->source;
+    out->priority     = s->priority;
+    out->len          = s->expected;
+    out->data         = buffers[s - sessions];
+    out->timestamp_us = msg->timestamp_us;
+
+    payloads[s->protocol]++;
+    session_release(s);
+    return TRANSPORT_COMPLETE;
+}
+
+/* ISO-TP */
+
+static TransportResult receive_isotp(const CAN_Message *msg, TransportPayload *out)
+{
+    static uint8_t single[8];
+    uint8_t pci = msg->data[0] >> 4;
+    TransportSession *s;
+
+    if (msg->dlc < 1)
+        return TRANSPORT_CONSUMED;
+
+    switch (pci) {
+    case ISOTP_SINGLE: {
+        uint8_t len = msg->data[0] & 0x0F;
+        if (len == 0 || len > msg->dlc - 1) {
+            errors[ERR_OVERFLOW]++;
+            return TRANSPORT_CONSUMED;
+        }
+        memcpy(single, msg->data + 1, len);
+        out->protocol     = TRANSPORT_ISOTP;
+        out->id           = msg->id;
+        out->source       = 0;
+        out->priority     = 0;
+        out->len          = len;
+        out->data         = single;
+        out->timestamp_us = msg->timestamp_us;
+        payloads[TRANSPORT_ISOTP]++;
+        return TRANSPORT_COMPLETE;
+    }
+
+    case ISOTP_FIRST: {
+        uint16_t len = (uint16_t)(((msg->data[0] & 0x0F) << 8) | msg->data[1]);
+        if (msg->dlc < 8 || len < 8) {
+            errors[ERR_OVERFLOW]++;
+            return TRANSPORT_CONSUMED;
+        }
+
+        s = session_open(KEY_ISOTP(msg->id), ISOTP_TIMEOUT_MS);
+        if (!s)
+            return TRANSPORT_CONSUMED;
+
+        s->protocol = TRANSPORT_ISOTP;
+        s->id       = msg->id;
+        s->expected = len;
+        s->received = 6;
+        s->next_seq = 1;
+        memcpy(buffers[s - sessions], msg->data + 2, 6);
+        return TRANSPORT_CONSUMED;
+    }
+
+    case ISOTP_CONSECUTIVE: {
+        s = session_find(KEY_ISOTP(msg->id));
+        if (!s)
+            return TRANSPORT_CONSUMED;     /* Tail of a transfer we did not see start */
+
+        if ((msg->data[0] & 0x0F) != s->next_seq) {
+            session_fail(s, ERR_SEQUENCE);
+            return TRANSPORT_CONSUMED;
+        }
+        if (s->received > s->expected) {
+            session_fail(s, ERR_OVERFLOW);
+            return TRANSPORT_CONSUMED;
+        }
+
+        int chunk = s->expected - s->received;
+        if (chunk > msg->dlc - 1)
+            chunk = msg->dlc - 1;
+        memcpy(buffers[s - sessions] + s->received, msg->data + 1, chunk);
+        s->received += chunk;
+        s->next_seq = (s->next_seq + 1) & 0x0F;
+
+        if (s->received >= s->expected)
+            return session_complete(s, msg, out);
+
+        session_touch(s);
+        return TRANSPORT_CONSUMED;
+    }
+
+    case ISOTP_FLOW_CONTROL:
+        return TRANSPORT_CONSUMED;
+
+    default:
+        return TRANSPORT_PASS;
+    }
+}
+
+/* J1939 TRANSPORT PROTOCOL */
+
+static uint32_t cm_pgn(const CAN_Message *msg)
+{
+    return msg->data[5] | (msg->data[6] << 8) | ((uint32_t)(msg->data[7] & 0x03) << 16);
+}
+
+static TransportResult receive_tp_cm(const CAN_Message *msg)
+{
+    uint8_t sa = j1939_source(msg->id);
+    uint8_t da = (uint8_t)((msg->id >> 8) & 0xFF);
+    TransportSession *s;
+
+    switch (msg->data[0]) {
+    case TP_CM_BAM:
+    case TP_CM_RTS: {
+        uint16_t size = (uint16_t)(msg->data[1] | (msg->data[2] << 8));
+        uint8_t  packets = msg->data[3];
+
+        if (size < 9 || size > J1939_MAX_PAYLOAD ||
+            packets != (size + J1939_DT_BYTES - 1) / J1939_DT_BYTES) {
+            errors[ERR_OVERFLOW]++;
+            return TRANSPORT_CONSUMED;
+        }
+
+        if (msg->data[0] == TP_CM_BAM)
+            da = J1939_ADDR_GLOBAL;
+
+        s = session_open(KEY_J1939(sa, da),
+                         msg->data[0] == TP_CM_BAM ? J1939_BAM_TIMEOUT_MS : J1939_RTS_TIMEOUT_MS);
+        if (!s)
+            return TRANSPORT_CONSUMED;
+
+        s->protocol = TRANSPORT_J1939;
+        s->id       = cm_pgn(msg);
+        s->source   = sa;
+        s->priority = (uint8_t)((msg->id >> 26) & 7);
+        s->expected = size;
+        s->packets  = packets;
+        s->next_seq = 1;
+        return TRANSPORT_CONSUMED;
+    }
+
+    case TP_CM_CTS:
+        /* Sent by the receiver: the session is keyed the other way round.
+         * It may ask for packets again, so follow its next sequence number.
+         */
+        s = session_find(KEY_J1939(da, sa));
+        if (s && msg->data[1] > 0) {
+            /* Any node can send this: only packets of the transfer are valid. */
+            if (msg->data[2] < 1 || msg->data[2] > s->packets) {
+                session_fail(s, ERR_SEQUENCE);
+                return TRANSPORT_CONSUMED;
+            }
+            s->next_seq = msg->data[2];
+            s->received = (uint16_t)((msg->data[2] - 1) * J1939_DT_BYTES);
+            session_touch(s);
+        }
+        return TRANSPORT_CONSUMED;
+
+    case TP_CM_ABORT:
+        if ((s = session_find(KEY_J1939(sa, da))) != NULL ||
+            (s = session_find(KEY_J1939(da, sa))) != NULL)
+            session_fail(s, ERR_ABORTED);
+        return TRANSPORT_CONSUMED;
+
+    default:                /* EOMA and reserved control bytes */
+        return TRANSPORT_CONSUMED;
+    }
+}
+
+static TransportResult receive_tp_dt(const CAN_Message *msg, TransportPayload *out)
+{
+    uint8_t sa = j1939_source(msg->id);
+    uint8_t da = (uint8_t)((msg->id >> 8) & 0xFF);
+    TransportSession *s = session_find(KEY_J1939(sa, da));
+
+    if (!s)
+        return TRANSPORT_CONSUMED;
+
+    if (msg->dlc < 8 || msg->data[0] != s->next_seq) {
+        session_fail(s, ERR_SEQUENCE);
+        return TRANSPORT_CONSUMED;
+    }
+    if (s->received > s->expected) {
+        session_fail(s, ERR_OVERFLOW);
+        return TRANSPORT_CONSUMED;
+    }
+
+    int chunk = s->expected - s->received;
+    if (chunk > J1939_DT_BYTES)
+        chunk = J1939_DT_BYTES;
+    memcpy(buffers[s - sessions] + s->received, msg->data + 1, chunk);
+    s->received += chunk;
+    s->next_seq++;
+
+    if (s->received >= s->expected)
+        return session_complete(s, msg, out);
+
+    session_touch(s);
+    return TRANSPORT_CONSUMED;
+}
+
+/* PUBLIC API */
+
+void transport_init(void)
+{
+    for (int i = 0; i < HASH_SIZE; i++)
+        buckets[i] = -1;
+
+    for (int i = 0; i < TRANSPORT_MAX_SESSIONS; i++)
+        sessions[i].next = (int8_t)(i + 1 < TRANSPORT_MAX_SESSIONS ? i + 1 : -1);
+    free_list = 0;
+
+    timer_wheel_init(&timeouts, now_ms());
+}
+
+void transport_register_isotp(uint32_t can_id)
+{
+    if (can_id < CAN_STD_ID_COUNT)
+        isotp_ids[can_id / 8] |= (uint8_t)(1 << (can_id % 8));
+}
+
+static int is_isotp(uint32_t id)
+{
+    return id < CAN_STD_ID_COUNT && (isotp_ids[id / 8] & (1 << (id % 8)));
+}
+
+int transport_is_segmented(const CAN_Message *msg)
+{
+    if (msg->id & CAN_EFF_FLAG) {
+        uint32_t pgn = j1939_pgn(msg->id);
+        return pgn == J1939_PGN_TP_CM || pgn == J1939_PGN_TP_DT;
+    }
+    return is_isotp(msg->id);
+}
+
+TransportResult transport_receive(const CAN_Message *msg, TransportPayload *out)
+{
+    timer_wheel_advance(&timeouts, now_ms(), on_timeout, NULL);
+
+    if (msg->id & CAN_EFF_FLAG) {
+        uint32_t pgn = j1939_pgn(msg->id);
+
+        if (pgn == J1939_PGN_TP_CM)
+            return msg->dlc == 8 ? receive_tp_cm(msg) : TRANSPORT_CONSUMED;
+        if (pgn == J1939_PGN_TP_DT)
+            return receive_tp_dt(msg, out);
+        return TRANSPORT_PASS;
+    }
+
+    if (is_isotp(msg->id))
+        return receive_isotp(msg, out);
+
+    return TRANSPORT_PASS;
+}
+
+/* SENDER SIDE */
+
+int transport_segment_isotp(uint32_t can_id, const uint8_t *data, uint16_t len,
+                            CAN_Message *out, int max)
+{
+    int count;
+
+    if (len == 0 || len > TRANSPORT_MAX_PAYLOAD)
+        return -1;
+
+    if (len <= 7) {
+        if (max < 1)
+            return -1;
+        memset(&out[0], 0, sizeof(out[0]));
+        out[0].id      = can_id;
+        out[0].dlc     = (uint8_t)(len + 1);
+        out[0].data[0] = (uint8_t)len;
+        memcpy(out[0].data + 1, data, len);
+        return 1;
+    }
+
+    count = 1 + (len - 6 + 6) / 7;       /* First frame, then 7 bytes per CF */
+    if (count > max)
+        return -1;
+
+    memset(out, 0, (size_t)count * sizeof(*out));
+    out[0].id      = can_id;
+    out[0].dlc     = 8;
+    out[0].data[0] = (uint8_t)((ISOTP_FIRST << 4) | (len >> 8));
+    out[0].data[1] = (uint8_t)(len & 0xFF);
+    memcpy(out[0].data + 2, data, 6);
+
+    int sent = 6;
+    for (int i = 1; i < count; i++) {
+        int chunk = len - sent < 7 ? len - sent : 7;
+        out[i].id      = can_id;
+        out[i].dlc     = (uint8_t)(chunk + 1);
+        out[i].data[0] = (uint8_t)((ISOTP_CONSECUTIVE << 4) | (i & 0x0F));
+        memcpy(out[i].data + 1, data + sent, chunk);
+        sent += chunk;
+    }
+
+    return count;
+}
+
+static void make_tp_cm(CAN_Message *msg, uint8_t priority, uint8_t source, uint8_t dest,
+                       uint8_t control, uint8_t b1, uint8_t b2, uint8_t b3, uint8_t b4,
+                       uint32_t pgn)
+{
+    memset(msg, 0, sizeof(*msg));
+    msg->id      = j1939_id(priority, J1939_PGN_TP_CM, dest, source);
+    msg->dlc     = 8;
+    msg->data[0] = control;
+    msg->data[1] = b1;
+    msg->data[2] = b2;
+    msg->data[3] = b3;
+    msg->data[4] = b4;
+    msg->data[5] = (uint8_t)(pgn & 0xFF);
+    msg->data[6] = (uint8_t)((pgn >> 8) & 0xFF);
+    msg->data[7] = (uint8_t)((pgn >> 16) & 0xFF);
+}
+
+int transport_segment_j1939(uint32_t pgn, uint8_t priority, uint8_t source, uint8_t dest,
+                            const uint8_t *data, uint16_t len, CAN_Message *out, int max)
+{
+    int bam = dest == J1939_ADDR_GLOBAL;
+
+    if (len < 9 || len > J1939_MAX_PAYLOAD)
+        return -1;
+
+    int packets = (len + J1939_DT_BYTES - 1) / J1939_DT_BYTES;
+    int count = packets + (bam ? 1 : 3);
+    if (count > max)
+        return -1;
+
+    uint8_t size_lo = (uint8_t)(len & 0xFF), size_hi = (uint8_t)(len >> 8);
+    int n = 0;
+
+    if (bam) {
+        make_tp_cm(&out[n++], priority, source, dest, TP_CM_BAM,
+                   size_lo, size_hi, (uint8_t)packets, 0xFF, pgn);
+    }
+    else {
+        make_tp_cm(&out[n++], priority, source, dest, TP_CM_RTS,
+                   size_lo, size_hi, (uint8_t)packets, (uint8_t)packets, pgn);
+        make_tp_cm(&out[n++], priority, dest, source, TP_CM_CTS,
+                   (uint8_t)packets, 1, 0xFF, 0xFF, pgn);
+    }
+
+    for (int i = 0; i < packets; i++) {
+        CAN_Message *dt = &out[n++];
+        int sent = i * J1939_DT_BYTES;
+        int chunk = len - sent < J1939_DT_BYTES ? len - sent : J1939_DT_BYTES;
+
+        memset(dt, 0, sizeof(*dt));
+        dt->id      = j1939_id(priority, J1939_PGN_TP_DT, dest, source);
+        dt->dlc     = 8;
+        dt->data[0] = (uint8_t)(i + 1);
+        memset(dt->data + 1, 0xFF, J1939_DT_BYTES);
+        memcpy(dt->data + 1, data + sent, chunk);
+    }
+
+    if (!bam) {
+        make_tp_cm(&out[n++], priority, dest, source, TP_CM_EOMA,
+                   size_lo, size_hi, (uint8_t)packets, 0xFF, pgn);
+    }
+
+    return n;
+}
+
+/* METRICS */
+
+int transport_write_metrics(char *buf, size_t len)
+{
+    int off = snprintf(buf, len,
+                       "# TYPE can_tp_sessions_active gauge\n"
+                       "can_tp_sessions_active %d\n"
+                       "# TYPE can_tp_sessions_high_watermark gauge\n"
+                       "can_tp_sessions_high_watermark %d\n"
+                       "# TYPE can_tp_payloads_total counter\n"
+                       "can_tp_payloads_total{protocol=\"isotp\"} %llu\n"
+                       "can_tp_payloads_total{protocol=\"j1939\"} %llu\n"
+                       "# TYPE can_tp_errors_total counter\n",
+                       active, high_watermark,
+                       (unsigned long long)payloads[TRANSPORT_ISOTP],
+                       (unsigned long long)payloads[TRANSPORT_J1939]);
+
+    for (int e = 0; e < ERR_COUNT && off > 0 && (size_t)off < len; e++) {
+        off += snprintf(buf + off, len - off, "can_tp_errors_total{reason=\"%s\"} %llu\n",
+                        error_names[e], (unsigned long long)errors[e]);
+    }
+
+    return (off > 0 && (size_t)off < len) ? off : (int)(len ? len - 1 : 0);
+}
@@ -0,0 +1,107 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_message.h"
+
+/* Transport-protocol reassembly in front of the decoder.
+ *
+ *   ISO-TP (ISO 15765-2)  single, first and consecutive frames on
+ *                         standard IDs registered with
+ *                         transport_register_isotp(); flow control
+ *                         frames on those IDs are consumed, they carry
+ *                         no signals
+ *   J1939-21 TP           BAM and RTS/CTS transfers (TP.CM / TP.DT) on
+ *                         extended IDs, one session per source and
+ *                         destination address
+ *
+ * The receiver is a passive bus monitor: it never sends flow control or
+ * CTS, it follows the ones the real peers exchange. Sessions come from a
+ * fixed pool with preallocated buffers and are found through a hash
+ * table, so neither malloc nor a linear search sits in the receive path.
+ * Stalled sessions time out on a timer wheel driven by received frames.
+ *
+ * Not thread-safe; call from the decode thread only.
+ */
+
+#define TRANSPORT_MAX_SESSIONS  32
+#define TRANSPORT_MAX_PAYLOAD   4095    /* ISO-TP limit; J1939 TP stops at 1785 */
+
+#define ISOTP_TIMEOUT_MS        1000    /* N_Cr: between consecutive frames */
+#define J1939_BAM_TIMEOUT_MS    750     /* T1: between BAM data packets */
+#define J1939_RTS_TIMEOUT_MS    1250    /* T2: waiting for data after CTS */
+
+#define J1939_PGN_TP_CM         0xEC00
+#define J1939_PGN_TP_DT         0xEB00
+#define J1939_ADDR_GLOBAL       0xFF
+
+typedef enum
+{
+    TRANSPORT_PASS,          /* Not a transport frame, decode it as is */
+    TRANSPORT_CONSUMED,      /* Part of a transfer (or invalid), nothing to decode */
+    TRANSPORT_COMPLETE       /* A payload was completed, see TransportPayload */
+} TransportResult;
+
+typedef enum
+{
+    TRANSPORT_ISOTP,
+    TRANSPORT_J1939
+} TransportProtocol;
+
+typedef struct
+{
+    TransportProtocol protocol;
+    uint32_t       id;            /* ISO-TP: CAN ID, J1939: PGN */
+    uint8_t        source;        /* J1939 source address */
+    uint8_t        priority;      /* J1939 priority of the TP.CM frame */
+    uint16_t       len;
+    const uint8_t *data;          /* Valid until the next transport_receive() */
+    uint64_t       timestamp_us;  /* Of the frame that completed the payload */
+} TransportPayload;
+
+/* J1939 identifier fields of an extended CAN ID. For PDU1 PGNs
+ * (PF < 240) the PS byte is the destination, not part of the PGN.
+ */
+uint32_t j1939_pgn(uint32_t id);
+uint8_t  j1939_source(uint32_t id);
+uint32_t j1939_id(uint8_t priority, uint32_t pgn, uint8_t dest, uint8_t source);
+
+void transport_init(void);
+
+/* Treat frames on a standard ID as ISO-TP. */
+void transport_register_isotp(uint32_t can_id);
+
+/* Non-zero if msg belongs to a transport protocol, so queues must not
+ * merge it with other frames of the same ID.
+ */
+int transport_is_segmented(const CAN_Message *msg);
+
+/* Feed one received frame. On TRANSPORT_COMPLETE, out describes the
+ * reassembled payload (single-frame ISO-TP messages complete at once).
+ */
+TransportResult transport_receive(const CAN_Message *msg, TransportPayload *out);
+
+/* SENDER SIDE (used by the simulator) */
+
+/* Split a payload into ISO-TP frames on can_id. Returns the number of
+ * frames written to out, or -1 if they do not fit max.
+ */
+int transport_segment_isotp(uint32_t can_id, const uint8_t *data, uint16_t len,
+                            CAN_Message *out, int max);
+
+/* Split a payload into a J1939 transfer: BAM when dest is
+ * J1939_ADDR_GLOBAL, otherwise RTS, CTS, data packets and EOMA (the
+ * destination's frames included). Returns the number of frames written
+ * to out, or -1 if they do not fit max.
+ */
+int transport_segment_j1939(uint32_t pgn, uint8_t priority, uint8_t source, uint8_t dest,
+                            const uint8_t *data, uint16_t len, CAN_Message *out, int max);
+
+/* Writes session and error counters in Prometheus text format.
+ * Returns bytes written.
+ */
+int transport_write_metrics(char *buf, size_t len);
+
+#endif /* TRANSPORT_H */
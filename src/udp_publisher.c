@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "udp_publisher.h"
+#include "data_model.h"
+#include "platform.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define close_socket closesocket
+#else
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#define close_socket close
+#endif
+
+#define UDP_DATAGRAM_MAX (UDP_HEADER_SIZE + UDP_MAX_ENTRIES * UDP_ENTRY_SIZE)
+
+/* PUBLISHER STATE */
+
+static int                publisher_fd = -1;
+static struct sockaddr_in publisher_dest;
+static int                batch_size = UDP_DEFAULT_BATCH;
+
+static uint8_t  datagram[UDP_DATAGRAM_MAX];
+static int      entry_count = 0;
+static uint32_t next_seq = 0;
+static uint64_t base_us = 0;         /* Sample time of the first queued entry */
+static uint64_t batch_started_us = 0;
+
+/* LITTLE-ENDIAN HELPERS */
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+    return p + 4;
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int is_multicast(const struct in_addr *a)
+{
+    return (ntohl(a->s_addr) & 0xF0000000u) == 0xE0000000u;
+}
+
+static void sockets_startup(void)
+{
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2,2), &wsa);
+#endif
+}
+
+/* PUBLIC API */
+
+int udp_parse_endpoint(const char *text, char *addr, int addr_len, uint16_t *port)
+{
+    const char *colon = strrchr(text, ':');
+    if (!colon || colon == text || colon - text >= addr_len)
+        return -1;
+
+    char *end;
+    long p = strtol(colon + 1, &end, 10);
+    if (*end != '\0' || p <= 0 || p > 65535)
+        return -1;
+
+    memcpy(addr, text, (size_t)(colon - text));
+    addr[colon - text] = '\0';
+    *port = (uint16_t)p;
+    return 0;
+}
+
+int udp_publisher_init(const char *addr, uint16_t port, int batch)
+{
+    sockets_startup();
+
+    memset(&publisher_dest, 0, sizeof(publisher_dest));
+    publisher_dest.sin_family      = AF_INET;
+    publisher_dest.sin_port        = htons(port);
+    publisher_dest.sin_addr.s_addr = inet_addr(addr);
+    if (publisher_dest.sin_addr.s_addr == INADDR_NONE) {
+        printf("ERROR: Invalid UDP address %s\n", addr);
+        return -1;
+    }
+
+    int fd = (int)socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    if (is_multicast(&publisher_dest.sin_addr)) {
+        /* Stay on the local segment and let local receivers see our own traffic. */
+        unsigned char ttl = 1, loop = 1;
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, (const char *)&ttl, sizeof(ttl));
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, (const char *)&loop, sizeof(loop));
+    }
+
+    if (batch <= 0)
+        batch = UDP_DEFAULT_BATCH;
+    if (batch > UDP_MAX_ENTRIES)
+        batch = UDP_MAX_ENTRIES;
+
+    batch_size   = batch;
+    publisher_fd = fd;
+    entry_count  = 0;
+
+    printf("UDP publisher sending to %s:%u (%d samples per datagram)\n",
+           addr, port, batch_size);
+    return 0;
+}
+
+void udp_publisher_flush(void)
+{
+    if (publisher_fd < 0 || entry_count == 0)
+        return;
+
+    uint8_t *h = datagram;
+    h = put_u16(h, UDP_MAGIC);
+    *h++ = UDP_VERSION;
+    *h++ = (uint8_t)entry_count;
+    h = put_u32(h, next_seq++);
+    h = put_u32(h, (uint32_t)base_us);
+    put_u32(h, (uint32_t)(base_us >> 32));
+
+    sendto(publisher_fd, (const char *)datagram,
+           UDP_HEADER_SIZE + entry_count * UDP_ENTRY_SIZE, 0,
+           (const struct sockaddr *)&publisher_dest, sizeof(publisher_dest));
+
+    entry_count = 0;
+}
+
+void udp_publisher_add(SignalHandle handle, uint8_t flags, float value, uint64_t timestamp_us)
+{
+    if (publisher_fd < 0)
+        return;
+
+    uint64_t now = platform_time_us();
+
+    /* Samples must fit the 32-bit offset from the datagram base time. */
+    if (entry_count > 0 &&
+        (timestamp_us < base_us || timestamp_us - base_us > 0xFFFFFFFFu))
+        udp_publisher_flush();
+
+    if (entry_count == 0) {
+        base_us = timestamp_us;
+        batch_started_us = now;
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint8_t *p = datagram + UDP_HEADER_SIZE + entry_count * UDP_ENTRY_SIZE;
+    p = put_u16(p, handle);
+    *p++ = flags;
+    *p++ = 0;
+    p = put_u32(p, bits);
+    put_u32(p, (uint32_t)(timestamp_us - base_us));
+    entry_count++;
+
+    if (entry_count >= batch_size || now - batch_started_us >= UDP_MAX_DELAY_US)
+        udp_publisher_flush();
+}
+
+/* RECEIVER (test tool) */
+
+int udp_receiver_run(const char *addr, uint16_t port)
+{
+    sockets_startup();
+
+    int fd = (int)socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family      = AF_INET;
+    local.sin_port        = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(fd, (struct sockaddr *)&local, sizeof(local)) < 0) {
+        perror("bind");
+        close_socket(fd);
+        return 1;
+    }
+
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr.s_addr = inet_addr(addr);
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (is_multicast(&mreq.imr_multiaddr) &&
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char *)&mreq, sizeof(mreq)) < 0) {
+        perror("IP_ADD_MEMBERSHIP");
+        close_socket(fd);
+        return 1;
+    }
+
+    printf("Listening for decoded samples on %s:%u\n", addr, port);
+
+    uint8_t  buf[UDP_DATAGRAM_MAX];
+    int      have_seq = 0;
+    uint32_t expected = 0;
+    uint64_t received = 0, lost = 0, reordered = 0;
+
+    while (1) {
+        int n = (int)recv(fd, (char *)buf, sizeof(buf), 0);
+        if (n < UDP_HEADER_SIZE || get_u16(buf) != UDP_MAGIC || buf[2] != UDP_VERSION)
+            continue;
+
+        int count = buf[3];
+        if (n < UDP_HEADER_SIZE + count * UDP_ENTRY_SIZE)
+            continue;
+
+        uint32_t seq  = get_u32(buf + 4);
+        uint64_t base = get_u32(buf + 8) | ((uint64_t)get_u32(buf + 12) << 32);
+
+        received++;
+        if (have_seq && seq != expected) {
+            if ((int32_t)(seq - expected) > 0) {
+                lost += seq - expected;
+                printf("GAP: %lu datagram(s) missing before seq %lu\n",
+                       (unsigned long)(seq - expected), (unsigned long)seq);
+            } else {
+                reordered++;
+                printf("LATE: seq %lu arrived out of order\n", (unsigned long)seq);
+                continue;
+            }
+        }
+        have_seq = 1;
+        expected = seq + 1;
+
+        printf("seq %lu | %d sample(s) | received %llu lost %llu late %llu\n",
+               (unsigned long)seq, count, (unsigned long long)received,
+               (unsigned long long)lost, (unsigned long long)reordered);
+
+        for (int i = 0; i < count; i++) {
+            const uint8_t *e = buf + UDP_HEADER_SIZE + i * UDP_ENTRY_SIZE;
+            SignalHandle handle = get_u16(e);
+            uint32_t bits = get_u32(e + 4);
+            uint64_t t = base + get_u32(e + 8);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+
+            const SignalInfo *info = signal_info(handle);
+            printf("  %llu.%06llu %-18s %10.2f %-4s %s\n",
+                   (unsigned long long)(t / 1000000u), (unsigned long long)(t % 1000000u),
+                   info ? info->name : "?", value, info ? info->unit : "",
+                   (e[2] & SIGNAL_FLAG_WARNING) ? "WARNING" : "OK");
+        }
+        fflush(stdout);
+    }
+
+    return 0;
+}
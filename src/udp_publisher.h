@@ -0,0 +1,59 @@
+#ifndef UDP_PUBLISHER_H
+#define UDP_PUBLISHER_H
+
+#include <stdint.h>
+
+#include "signal_registry.h"
+
+/* UDP publication of decoded samples (multicast or unicast).
+ *
+ * Samples leaving the compression stage are batched into datagrams.
+ * All fields are little-endian:
+ *
+ *   u16 magic      UDP_MAGIC
+ *   u8  version    UDP_VERSION
+ *   u8  count      number of entries that follow
+ *   u32 seq        datagram sequence number, +1 per datagram
+ *   u64 base_us    sample time of the first entry (µs since the Unix epoch)
+ *   count x {
+ *       u16 handle   signal handle (index into /schema)
+ *       u8  flags    SIGNAL_FLAG_*
+ *       u8  reserved
+ *       f32 value    physical value
+ *       u32 dt_us    sample time - base_us
+ *   }
+ *
+ * A gap in seq means datagrams were lost.
+ */
+
+#define UDP_MAGIC          0xCA7Eu
+#define UDP_VERSION        1
+#define UDP_HEADER_SIZE    16
+#define UDP_ENTRY_SIZE     12
+#define UDP_MAX_ENTRIES    112  /* Keeps datagrams below a 1400-byte MTU budget */
+#define UDP_DEFAULT_BATCH  32
+#define UDP_MAX_DELAY_US   50000 /* A started batch is sent after at most 50 ms */
+
+/* Parse "a.b.c.d:port". Returns 0 on success, -1 on malformed input. */
+int udp_parse_endpoint(const char *text, char *addr, int addr_len, uint16_t *port);
+
+/* Open the publisher socket towards addr:port. Multicast addresses get
+ * TTL 1 and loopback enabled. batch is the number of samples per
+ * datagram (0 = default). Returns 0 on success, -1 on failure.
+ */
+int udp_publisher_init(const char *addr, uint16_t port, int batch);
+
+/* Queue one sample; sends a datagram when the batch is full or old.
+ * Does nothing if the publisher is not initialized.
+ */
+void udp_publisher_add(SignalHandle handle, uint8_t flags, float value, uint64_t timestamp_us);
+
+/* Send any queued samples now. */
+void udp_publisher_flush(void);
+
+/* Receive and print datagrams on addr:port until interrupted,
+ * reporting sequence gaps. Returns non-zero on setup failure.
+ */
+int udp_receiver_run(const char *addr, uint16_t port);
+
+#endif /* UDP_PUBLISHER_H */
@@ -4,8 +4,21 @@
 
 #include "web_server.h"
 #include "data_model.h"
-
-/* DASHBOARD HTML */
+#include "static_files.h"
+#include "delta_protocol.h"
+#include "compression.h"
+#include "scenario.h"
+#include "pipeline.h"
+#include "supervision.h"
+#include "e2e.h"
+#include "transport.h"
+#include "signal_stats.h"
+#include "bus_analyzer.h"
+#include "signal_registry.h"
+
+/* DASHBOARD HTML
+ * Fallback page used when the web root has no index.html.
+ */
 
 static const char *dashboard_html =
 "<!DOCTYPE html>"
@@ -38,6 +51,9 @@ static const char *dashboard_html =
 ".unit{font-size:0.85rem;color:#475569;margin-top:6px;}"
 ".warn{margin-top:8px;color:#dc2626;font-weight:700;font-size:0.8rem;}"
 ".test-entry{margin-top:10px;text-align:left;font-size:0.85rem;}"
+"table{width:100%;border-collapse:collapse;margin-top:12px;font-size:0.85rem;}"
+"th,td{padding:4px 8px;text-align:right;border-bottom:1px solid #e2e8f0;}"
+"th:first-child,td:first-child{text-align:left;}"
 "</style>"
 "</head>"
 
@@ -46,46 +62,16 @@ static const char *dashboard_html =
 
 "<div class='dashboard'>"
 
-/* MOTOR RPM */
-"<div class='card'>"
-"<div class='icon'>⏱️</div>"
-"<div class='label'>Motor RPM</div>"
-"<div class='value'><span id='rpm'>---</span></div>"
-"<div class='unit'>rpm</div>"
-"<div id='rpm_warn' class='warn'></div>"
-"</div>"
-
-/* VEHICLE SPEED */
-"<div class='card'>"
-"<div class='icon'>🏎️</div>"
-"<div class='label'>Vehicle Speed</div>"
-"<div class='value'><span id='speed'>---</span></div>"
-"<div class='unit'>km/h</div>"
-"<div id='speed_warn' class='warn'></div>"
-"</div>"
-
-/* BATTERY VOLTAGE */
-"<div class='card'>"
-"<div class='icon'>⚡</div>"
-"<div class='label'>Battery Voltage</div>"
-"<div class='value'><span id='volt'>---</span></div>"
-"<div class='unit'>V</div>"
-"</div>"
-
-/* BATTERY SOC */
-"<div class='card'>"
-"<div class='icon'>🔋</div>"
-"<div class='label'>Battery SOC</div>"
-"<div class='value'><span id='soc'>---</span></div>"
-"<div class='unit'>%</div>"
-"</div>"
+/* SIGNAL CARDS (built from /schema) */
+"<div id='cards' style='display:contents'></div>"
 
-/* MOTOR TEMPERATURE */
-"<div class='card'>"
-"<div class='icon'>🌡️</div>"
-"<div class='label'>Motor Temperature</div>"
-"<div class='value'><span id='temp'>---</span></div>"
-"<div class='unit'>°C</div>"
+/* BUS LOAD AND TIMING (from /bus) */
+"<div class='test-card'>"
+"<div class='label'>Bus Load</div>"
+"<div class='value' id='bus_load'>---</div>"
+"<div class='unit' id='bus_summary'></div>"
+"<table><thead><tr><th>ID</th><th>Frames</th><th>Rate (Hz)</th><th>Period (ms)</th>"
+"<th>Jitter (ms)</th><th>Max gap (ms)</th></tr></thead><tbody id='bus_ids'></tbody></table>"
 "</div>"
 
 /* TEST RESULTS */
@@ -97,7 +83,21 @@ static const char *dashboard_html =
 "</div>"
 
 "<script>"
+"let schema=null;"
+"async function loadSchema(){"
+"const r=await fetch('/schema');"
+"schema=(await r.json()).signals;"
+"let html='';"
+"schema.forEach(function(sig){"
+"html+=\"<div class='card'><div class='label'>\"+sig.label+\"</div>\";"
+"html+=\"<div class='value'><span id='v_\"+sig.name+\"'>---</span></div>\";"
+"html+=\"<div class='unit'>\"+sig.unit+\"</div>\";"
+"html+=\"<div id='w_\"+sig.name+\"' class='warn'></div></div>\";"
+"});"
+"document.getElementById('cards').innerHTML=html;"
+"}"
 "async function update(){"
+"if(!schema)await loadSchema();"
 "const r=await fetch('/data');"
 "const d=await r.json();"
 
@@ -114,18 +114,27 @@ static const char *dashboard_html =
 "return;"
 "}"
 
-"document.getElementById('rpm').innerText=d.motor_rpm;"
-"document.getElementById('speed').innerText=d.vehicle_speed;"
-"document.getElementById('soc').innerText=d.battery_soc;"
-"document.getElementById('volt').innerText=d.battery_voltage;"
-"document.getElementById('temp').innerText=d.motor_temperature;"
-"document.getElementById('rpm_warn').innerText=d.rpm_warning?'RPM OUT OF RANGE':'';"
-"document.getElementById('speed_warn').innerText=d.speed_warning?'SPEED OUT OF RANGE':'';"
-"document.getElementById('soc_warn').innerText=d.soc_warning?'SOC OUT OF RANGE':'';"
-"document.getElementById('voltage_warn').innerText=d.voltage_warning?'VOLTAGE OUT OF RANGE':'';"
-"document.getElementById('temp_warn').innerText=d.temp_warning?'TEMPERATURE OUT OF RANGE':'';"
+"schema.forEach(function(sig){"
+"document.getElementById('v_'+sig.name).innerText=d[sig.name];"
+"document.getElementById('w_'+sig.name).innerText="
+"d[sig.name+'_stale']?'NO DATA':"
+"d[sig.name+'_warning']?sig.label.toUpperCase()+' OUT OF RANGE':'';"
+"});"
+"}"
+"async function updateBus(){"
+"const b=await (await fetch('/bus')).json();"
+"document.getElementById('bus_load').innerText=b.load_pct.toFixed(1)+' %';"
+"document.getElementById('bus_summary').innerText="
+"b.frames_per_s+' frames/s, peak '+b.peak_load_pct.toFixed(1)+' %, '+(b.bitrate/1000)+' kbit/s';"
+"let html='';"
+"b.ids.sort(function(x,y){return x.id<y.id?-1:1;}).forEach(function(t){"
+"html+='<tr><td>'+t.id+'</td><td>'+t.frames+'</td><td>'+t.rate_hz+'</td><td>'+t.period_ms.toFixed(1)+"
+"'</td><td>'+t.jitter_ms.toFixed(2)+'</td><td>'+t.max_gap_ms.toFixed(1)+'</td></tr>';"
+"});"
+"document.getElementById('bus_ids').innerHTML=html;"
 "}"
 "setInterval(update,500);update();"
+"setInterval(updateBus,1000);updateBus();"
 "</script>"
 
 "</body></html>";
@@ -136,7 +145,9 @@ static const char *dashboard_html =
 #ifdef _WIN32
 #include <winsock2.h>
 #pragma comment(lib,"ws2_32.lib")
+#define strncasecmp _strnicmp
 #else
+#include <strings.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -144,6 +155,107 @@ static const char *dashboard_html =
 
 #define PORT 8080
 #define BUFFER_SIZE 4096
+#define DEFAULT_WEB_ROOT "."
+
+/* /data and /schema responses: headers plus at most 192 bytes per
+ * registered signal (three 31-char names and two formatted floats).
+ */
+#define SIGNAL_RESP_SIZE (512 + MAX_SIGNALS * 192)
+
+/* REQUEST PARSING */
+
+/* Copies the request path (without query string) into path and the
+ * query string (without '?') into query.
+ * Returns 0 for a well-formed GET request line, -1 otherwise.
+ */
+static int parse_request_path(const char *req, char *path, size_t len,
+                              char *query, size_t query_len)
+{
+    if (strncmp(req, "GET ", 4) != 0)
+        return -1;
+
+    const char *p = req + 4;
+    size_t n = strcspn(p, " ?\r\n");
+    if (n == 0 || n >= len)
+        return -1;
+
+    memcpy(path, p, n);
+    path[n] = '\0';
+
+    query[0] = '\0';
+    if (p[n] == '?') {
+        size_t q = strcspn(p + n + 1, " \r\n");
+        if (q >= query_len)
+            q = query_len - 1;
+        memcpy(query, p + n + 1, q);
+        query[q] = '\0';
+    }
+    return 0;
+}
+
+/* Returns the unsigned value of a key=value query parameter, or 0. */
+static unsigned long query_param_ulong(const char *query, const char *key)
+{
+    size_t key_len = strlen(key);
+
+    const char *p = query;
+
+    while (p && *p) {
+        if (strncmp(p, key, key_len) == 0 && p[key_len] == '=')
+            return strtoul(p + key_len + 1, NULL, 10);
+        p = strchr(p, '&');
+        if (p)
+            p++;
+    }
+    return 0;
+}
+
+/* Finds a request header and copies its value into out.
+ * Returns out, or NULL if the header is absent.
+ */
+static const char *find_header(const char *req, const char *name, char *out, size_t len)
+{
+    size_t name_len = strlen(name);
+    const char *line = strstr(req, "\r\n");
+
+    while (line && line[2] != '\r' && line[2] != '\0') {
+        line += 2;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *v = line + name_len + 1;
+            while (*v == ' ')
+                v++;
+            size_t n = strcspn(v, "\r\n");
+            if (n >= len)
+                n = len - 1;
+            memcpy(out, v, n);
+            out[n] = '\0';
+            return out;
+        }
+        line = strstr(line, "\r\n");
+    }
+    return NULL;
+}
+
+static void close_client(int client)
+{
+#ifdef _WIN32
+    closesocket(client);
+#else
+    close(client);
+#endif
+}
+
+/* Send a status line with an empty body. */
+static void send_status(int client, const char *status)
+{
+    char hdr[128];
+    int hdr_len=snprintf(hdr,sizeof(hdr),
+        "HTTP/1.1 %s\r\n"
+        "Content-Length: 0\r\n"
+        "Connection: close\r\n\r\n",
+        status);
+    send(client,hdr,hdr_len,0);
+}
 
 /* WEB SERVER */
 
@@ -161,6 +273,10 @@ void start_web_server(void)
     server_fd = socket(AF_INET,SOCK_STREAM,0);
     if(server_fd<0){perror("socket");return;}
 
+    /* The server closes first, so allow rebinding over TIME_WAIT sockets. */
+    int reuse=1;
+    setsockopt(server_fd,SOL_SOCKET,SO_REUSEADDR,(const char*)&reuse,sizeof(reuse));
+
     addr.sin_family=AF_INET;
     addr.sin_addr.s_addr=inet_addr("127.0.0.1");
     addr.sin_port=htons(PORT);
@@ -170,7 +286,11 @@ void start_web_server(void)
         return;
     }
 
-    listen(server_fd,3);
+    listen(server_fd,16);
+
+    const char *root = getenv("CAN_WEB_ROOT");
+    static_files_init(root ? root : DEFAULT_WEB_ROOT);
+
     printf("Web server running at http://localhost:%d\n",PORT);
 
     while(1){
@@ -191,76 +311,174 @@ void start_web_server(void)
         read(client,buffer,BUFFER_SIZE-1);
 #endif
 
-        /* ROOT */
-        if(strncmp(buffer,"GET / ",6)==0){
-            const char *hdr=
-                "HTTP/1.1 200 OK\r\n"
-                "Content-Type: text/html\r\n"
-                "Connection: close\r\n\r\n";
-            send(client,hdr,strlen(hdr),0);
-            send(client,dashboard_html,strlen(dashboard_html),0);
-#ifdef _WIN32
-            closesocket(client);
-#else
-            close(client);
-#endif
+        char path[256];
+        char query[128];
+        if(parse_request_path(buffer,path,sizeof(path),query,sizeof(query))<0){
+            close_client(client);
             continue;
         }
 
         /* DATA */
-        if(strncmp(buffer,"GET /data",9)==0){
-            char resp[4096];
+        if(strcmp(path,"/data")==0){
+            static char resp[SIGNAL_RESP_SIZE];
+            int off;
 
             if(g_vehicle_data.mode==1){
-                int off=snprintf(resp,sizeof(resp),
+                off=snprintf(resp,sizeof(resp),
                     "HTTP/1.1 200 OK\r\n"
                     "Content-Type: application/json\r\n"
                     "Connection: close\r\n\r\n"
                     "{\"mode\":1,\"tests\":[");
-                for(int i=0;i<g_vehicle_data.test_dashboard.count;i++){
+                for(int i=0;i<g_vehicle_data.test_dashboard.count&&off<(int)sizeof(resp);i++){
                     TestResult *t=&g_vehicle_data.test_dashboard.results[i];
                     off+=snprintf(resp+off,sizeof(resp)-off,
                         "{\"name\":\"%s\",\"input\":\"%s\",\"output\":\"%s\",\"status\":%d}%s",
                         t->name,t->input,t->output,t->status,
                         (i<g_vehicle_data.test_dashboard.count-1)?",":"");
                 }
-                snprintf(resp+off,sizeof(resp)-off,"]}");
+                if(off<(int)sizeof(resp))
+                    off+=snprintf(resp+off,sizeof(resp)-off,"]}");
             } else {
-                snprintf(resp,sizeof(resp),
+                off=snprintf(resp,sizeof(resp),
                     "HTTP/1.1 200 OK\r\n"
                     "Content-Type: application/json\r\n"
                     "Connection: close\r\n\r\n"
-                    "{"
-                    "\"mode\":2,"
-                    "\"motor_rpm\":%.2f,"
-                    "\"rpm_warning\":%d,"
-                    "\"vehicle_speed\":%.2f,"
-                    "\"speed_warning\":%d,"
-                    "\"battery_soc\":%.2f,"
-                    "\"soc_warning\":%d,"
-                    "\"battery_voltage\":%.2f,"
-                    "\"voltage_warning\":%d,"
-                    "\"motor_temperature\":%.2f,"
-                    "\"temp_warning\":%d"
-                    "}",
-                    g_vehicle_data.motor_rpm,
-                    g_vehicle_data.rpm_warning,
-                    g_vehicle_data.vehicle_speed,
-                    g_vehicle_data.speed_warning,
-                    g_vehicle_data.battery_soc,
-                    g_vehicle_data.soc_warning,
-                    g_vehicle_data.battery_voltage,
-                    g_vehicle_data.voltage_warning,
-                    g_vehicle_data.motor_temperature,
-                    g_vehicle_data.temp_warning);
+                    "{\"mode\":2");
+                for(int i=0;i<signal_count()&&off<(int)sizeof(resp);i++){
+                    const SignalInfo *info=signal_info((SignalHandle)i);
+                    off+=snprintf(resp+off,sizeof(resp)-off,
+                        ",\"%s\":%.2f,\"%s_warning\":%d,\"%s_stale\":%d",
+                        info->key,g_vehicle_data.values[i],
+                        info->key,(g_vehicle_data.flags[i]&SIGNAL_FLAG_WARNING)?1:0,
+                        info->key,(g_vehicle_data.flags[i]&SIGNAL_FLAG_STALE)?1:0);
+                }
+                if(off<(int)sizeof(resp))
+                    off+=snprintf(resp+off,sizeof(resp)-off,"}");
             }
 
-            send(client,resp,strlen(resp),0);
-#ifdef _WIN32
-            closesocket(client);
-#else
-            close(client);
-#endif
+            /* Never send JSON cut off mid-way. */
+            if(off<(int)sizeof(resp))
+                send(client,resp,off,0);
+            else
+                send_status(client,"500 Internal Server Error");
+            close_client(client);
+            continue;
+        }
+
+        /* BINARY DELTA UPDATES */
+        if(strcmp(path,"/data.bin")==0){
+            uint8_t frame[1024];
+            char hdr[256];
+            int frame_len=delta_protocol_write_frame(
+                (uint32_t)query_param_ulong(query,"since"),frame,sizeof(frame));
+            if(frame_len<0) frame_len=0;
+            int hdr_len=snprintf(hdr,sizeof(hdr),
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: application/octet-stream\r\n"
+                "Content-Length: %d\r\n"
+                "Cache-Control: no-store\r\n"
+                "Connection: close\r\n\r\n",
+                frame_len);
+            send(client,hdr,hdr_len,0);
+            send(client,(const char*)frame,frame_len,0);
+            close_client(client);
+            continue;
+        }
+
+        /* SCHEMA FOR BINARY UPDATES */
+        if(strcmp(path,"/schema")==0){
+            static char resp[SIGNAL_RESP_SIZE];
+            int off=snprintf(resp,sizeof(resp),
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: application/json\r\n"
+                "Connection: close\r\n\r\n");
+            int n=delta_protocol_write_schema(resp+off,sizeof(resp)-off);
+
+            /* Without a schema the dashboard cannot decode /data.bin. */
+            if(n>0)
+                send(client,resp,off+n,0);
+            else
+                send_status(client,"500 Internal Server Error");
+            close_client(client);
+            continue;
+        }
+
+        /* SIGNAL STATISTICS */
+        if(strcmp(path,"/stats")==0){
+            static char resp[32768];
+            int off=snprintf(resp,sizeof(resp),
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: application/json\r\n"
+                "Cache-Control: no-store\r\n"
+                "Connection: close\r\n\r\n");
+            off+=signal_stats_write_json(resp+off,sizeof(resp)-off);
+            send(client,resp,off,0);
+            close_client(client);
+            continue;
+        }
+
+        /* BUS LOAD AND TIMING */
+        if(strcmp(path,"/bus")==0){
+            static char resp[32768];
+            int off=snprintf(resp,sizeof(resp),
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: application/json\r\n"
+                "Cache-Control: no-store\r\n"
+                "Connection: close\r\n\r\n");
+            off+=bus_analyzer_write_json(resp+off,sizeof(resp)-off);
+            send(client,resp,off,0);
+            close_client(client);
+            continue;
+        }
+
+        /* METRICS (Prometheus text format) */
+        if(strcmp(path,"/metrics")==0){
+            static char resp[65536];
+            int off=snprintf(resp,sizeof(resp),
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/plain; version=0.0.4\r\n"
+                "Cache-Control: no-store\r\n"
+                "Connection: close\r\n\r\n");
+            off+=compression_write_metrics(resp+off,sizeof(resp)-off);
+            off+=scenario_write_metrics(resp+off,sizeof(resp)-off);
+            off+=pipeline_write_metrics(resp+off,sizeof(resp)-off);
+            off+=supervision_write_metrics(resp+off,sizeof(resp)-off);
+            off+=e2e_write_metrics(resp+off,sizeof(resp)-off);
+            off+=transport_write_metrics(resp+off,sizeof(resp)-off);
+            off+=bus_analyzer_write_metrics(resp+off,sizeof(resp)-off);
+            send(client,resp,off,0);
+            close_client(client);
+            continue;
+        }
+
+        /* STATIC ASSETS */
+        char accept_encoding[128];
+        char if_none_match[128];
+        if(static_files_serve(client,path,
+               find_header(buffer,"Accept-Encoding",accept_encoding,sizeof(accept_encoding)),
+               find_header(buffer,"If-None-Match",if_none_match,sizeof(if_none_match)))==0){
+            close_client(client);
+            continue;
+        }
+
+        /* ROOT (built-in dashboard) */
+        if(strcmp(path,"/")==0){
+            char hdr[256];
+            size_t body_len=strlen(dashboard_html);
+            int hdr_len=snprintf(hdr,sizeof(hdr),
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/html\r\n"
+                "Content-Length: %lu\r\n"
+                "Cache-Control: no-cache\r\n"
+                "Connection: close\r\n\r\n",
+                (unsigned long)body_len);
+            send(client,hdr,hdr_len,0);
+            send(client,dashboard_html,(int)body_len,0);
+            close_client(client);
+            continue;
         }
+
+        send_status(client,"404 Not Found");
+        close_client(client);
     }
 }
\ No newline at end of file